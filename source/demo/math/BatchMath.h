@@ -0,0 +1,39 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Math
+{
+	/*
+		Batch math kernels.
+
+		Kernels process the contiguous arrays of rects and points at once. Each rect is loaded as single SSE register,
+		and AVX kernels process two rects per iteration where AVX is available. Scalar code is used on other targets.
+		The results of kernels are the same as the results of corresponding `BoundingRect` functions.
+
+		Masks are written as array of 64-bit words, where the bit `index % 64` of word `index / 64` corresponds to the rect by `index`.
+		The array of masks should have `GetMaskWordsCount( count )` words.
+	*/
+
+	// Count of bits in single word of mask.
+	constexpr size_t MASK_WORD_BITS = 64;
+
+
+	// Get the count of mask words, required to store the mask for given count of rects.
+	inline constexpr size_t GetMaskWordsCount( const size_t count )		{ return ( count + MASK_WORD_BITS - 1 ) / MASK_WORD_BITS; };
+
+
+	// Grow the `bounds` to contain every given rect.
+	inline BoundingRect& GrowAll( BoundingRect& bounds, const BoundingRect* rects, const size_t count );
+
+	// Test each of given rects for intersection with `bounds`. Bit is set for each rect, which intersects the `bounds`.
+	inline void IntersectsMask( const BoundingRect& bounds, const BoundingRect* rects, const size_t count, uint64_t* masks );
+
+	// Test each of given rects for lying totally inside the `bounds`. Bit is set for each rect, which the `bounds` consists of.
+	inline void ContainsMask( const BoundingRect& bounds, const BoundingRect* rects, const size_t count, uint64_t* masks );
+
+	// Get the center point of each given rect.
+	inline void CentersOf( const BoundingRect* rects, const size_t count, Vector2f* centers );
+}
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Math
+{
+namespace Internal
+{
+#if defined( DEMO_MATH_SSE2 )
+	// Load the rect into SSE register as `{ min.x, min.y, max.x, max.y }`.
+	inline __m128 LoadRect( const BoundingRect& rect )
+	{
+		return _mm_loadu_ps( &rect.min.x );
+	}
+
+	// Get the mask of rects, which components are all less or equal to the reference ones after the signs of components were flipped.
+	// Comparison `a >= b` is turned into `-a <= -b` by flipping the signs, so both bounds of rect are tested by single comparison.
+	inline void CompareRects( const __m128 signs, const __m128 reference, const BoundingRect* rects, const size_t count, uint64_t* masks )
+	{
+		std::fill( masks, masks + GetMaskWordsCount( count ), uint64_t( 0 ) );
+
+		size_t index = 0;
+	#if defined( DEMO_MATH_AVX )
+		const __m256 wide_signs		= _mm256_set_m128( signs, signs );
+		const __m256 wide_reference	= _mm256_set_m128( reference, reference );
+		for( ; index + 2 <= count; index += 2 )
+		{
+			const __m256 flipped_rects	= _mm256_mul_ps( _mm256_loadu_ps( &rects[ index ].min.x ), wide_signs );
+			const uint32_t rects_mask	= uint32_t( _mm256_movemask_ps( _mm256_cmp_ps( flipped_rects, wide_reference, _CMP_LE_OQ ) ) );
+
+			masks[ index / MASK_WORD_BITS ] |= uint64_t( ( rects_mask & 0xF ) == 0xF ) << ( index % MASK_WORD_BITS );
+			masks[ index / MASK_WORD_BITS ] |= uint64_t( ( rects_mask >> 4 ) == 0xF ) << ( ( index + 1 ) % MASK_WORD_BITS );
+		}
+	#endif
+
+		for( ; index < count; ++index )
+		{
+			const __m128 flipped_rect	= _mm_mul_ps( LoadRect( rects[ index ] ), signs );
+			const uint32_t components	= uint32_t( _mm_movemask_ps( _mm_cmple_ps( flipped_rect, reference ) ) );
+
+			masks[ index / MASK_WORD_BITS ] |= uint64_t( components == 0xF ) << ( index % MASK_WORD_BITS );
+		}
+	}
+#endif
+}
+
+
+	inline BoundingRect& GrowAll( BoundingRect& bounds, const BoundingRect* rects, const size_t count )
+	{
+	#if defined( DEMO_MATH_SSE2 )
+		// Maximum is found as the negated minimum of negated values, so both bounds are grown by single operation.
+		const __m128 signs = _mm_setr_ps( 1.0f, 1.0f, -1.0f, -1.0f );
+
+		__m128 grown_bounds = _mm_mul_ps( Internal::LoadRect( bounds ), signs );
+		for( size_t index = 0; index < count; ++index )
+		{
+			grown_bounds = _mm_min_ps( grown_bounds, _mm_mul_ps( Internal::LoadRect( rects[ index ] ), signs ) );
+		}
+
+		_mm_storeu_ps( &bounds.min.x, _mm_mul_ps( grown_bounds, signs ) );
+	#else
+		for( size_t index = 0; index < count; ++index )
+		{
+			bounds.Grow( rects[ index ] );
+		}
+	#endif
+
+		return bounds;
+	}
+
+	inline void IntersectsMask( const BoundingRect& bounds, const BoundingRect* rects, const size_t count, uint64_t* masks )
+	{
+	#if defined( DEMO_MATH_SSE2 )
+		// Rect intersects the bounds if `rect.min <= bounds.max` and `-rect.max <= -bounds.min`.
+		const __m128 signs		= _mm_setr_ps( 1.0f, 1.0f, -1.0f, -1.0f );
+		const __m128 reference	= _mm_setr_ps( bounds.max.x, bounds.max.y, -bounds.min.x, -bounds.min.y );
+		Internal::CompareRects( signs, reference, rects, count, masks );
+	#else
+		std::fill( masks, masks + GetMaskWordsCount( count ), uint64_t( 0 ) );
+		for( size_t index = 0; index < count; ++index )
+		{
+			masks[ index / MASK_WORD_BITS ] |= uint64_t( bounds.IsIntersects( rects[ index ] ) ) << ( index % MASK_WORD_BITS );
+		}
+	#endif
+	}
+
+	inline void ContainsMask( const BoundingRect& bounds, const BoundingRect* rects, const size_t count, uint64_t* masks )
+	{
+	#if defined( DEMO_MATH_SSE2 )
+		// Rect lies inside the bounds if `-rect.min <= -bounds.min` and `rect.max <= bounds.max`.
+		const __m128 signs		= _mm_setr_ps( -1.0f, -1.0f, 1.0f, 1.0f );
+		const __m128 reference	= _mm_setr_ps( -bounds.min.x, -bounds.min.y, bounds.max.x, bounds.max.y );
+		Internal::CompareRects( signs, reference, rects, count, masks );
+	#else
+		std::fill( masks, masks + GetMaskWordsCount( count ), uint64_t( 0 ) );
+		for( size_t index = 0; index < count; ++index )
+		{
+			masks[ index / MASK_WORD_BITS ] |= uint64_t( bounds.ConsistsOf( rects[ index ] ) ) << ( index % MASK_WORD_BITS );
+		}
+	#endif
+	}
+
+	inline void CentersOf( const BoundingRect* rects, const size_t count, Vector2f* centers )
+	{
+		size_t index = 0;
+	#if defined( DEMO_MATH_SSE2 )
+		// Centers of two rects are stored by single operation.
+		const __m128 half = _mm_set1_ps( 0.5f );
+		for( ; index + 2 <= count; index += 2 )
+		{
+			const __m128 first_rect		= Internal::LoadRect( rects[ index ] );
+			const __m128 second_rect	= Internal::LoadRect( rects[ index + 1 ] );
+
+			const __m128 mins = _mm_movelh_ps( first_rect, second_rect );
+			const __m128 maxs = _mm_movehl_ps( second_rect, first_rect );
+			_mm_storeu_ps( &centers[ index ].x, _mm_mul_ps( _mm_add_ps( mins, maxs ), half ) );
+		}
+	#endif
+
+		for( ; index < count; ++index )
+		{
+			centers[ index ] = rects[ index ].GetCenter();
+		}
+	}
+}
+}
@@ -10,7 +10,8 @@ inline namespace Math
 
 		Bounding rect is represented by minimum and maximum points. All four corners of axis-aligned box may be deduced by combining of this points components.
 		It also provide some minimal necessary subset of functions.
-		Bounding rect instances are swappable.
+		Bounding rect instances are swappable and trivially copyable, so the collections of rects may be copied as plain memory.
+		Rect is packed as `{ min.x, min.y, max.x, max.y }`, so it may be loaded as single SIMD register.
 	*/
 	struct BoundingRect final
 	{
@@ -28,7 +29,7 @@ inline namespace Math
 
 		inline BoundingRect() noexcept							= default;
 		inline BoundingRect( const BoundingRect& ) noexcept		= default;
-		inline BoundingRect( BoundingRect&& other ) noexcept	: min{ std::move( other.min ) }, max{ std::move( other.max ) } {};
+		inline BoundingRect( BoundingRect&& ) noexcept			= default;
 		inline ~BoundingRect() noexcept							= default;
 
 		inline explicit BoundingRect( const Vector2f& point ) noexcept;
@@ -37,7 +38,7 @@ inline namespace Math
 
 
 		inline BoundingRect& operator = ( const BoundingRect& ) noexcept	= default;
-		inline BoundingRect& operator = ( BoundingRect&& other ) noexcept	{ BoundingRect{ std::move( other ) }.Swap( *this ); return *this; };
+		inline BoundingRect& operator = ( BoundingRect&& ) noexcept		= default;
 
 
 		// Performs the value swapping.
@@ -65,6 +66,9 @@ inline namespace Math
 		// Get the size of rect.
 		inline Vector2f GetSize() const;
 
+		// Get the quarter of rect by index. Quarter lies between the center and the corner with same index.
+		inline BoundingRect GetQuarter( const size_t index ) const;
+
 		// Get the index of nearest corner for given point.
 		inline const size_t GetNearestCornerIndex( const Vector2f& point ) const;
 
@@ -80,6 +84,21 @@ inline namespace Math
 
 		// Whether the rect intersects with circle given by center point and radius.
 		inline const bool IsIntersects( const Vector2f& center, const float radius ) const;
+
+		// Get the time, when the segment from `origin` along `displacement` enters the rect.
+		// The time lies in range `[0, 1]`, or it is infinity if the segment misses the rect.
+		inline const float GetEntryTime( const Vector2f& origin, const Vector2f& displacement ) const;
+
+		// Get the time, when this rect moving along `displacement` touches the `obstacle` rect.
+		// The time lies in range `[0, 1]`, or it is infinity if the moving rect misses the obstacle.
+		inline const float GetSweepTime( const BoundingRect& obstacle, const Vector2f& displacement ) const;
+
+		// Classify the given rect against this rect.
+		inline const Containment Classify( const BoundingRect& rect ) const;
 	};
+
+
+	static_assert( std::is_trivially_copyable_v<BoundingRect>, "BoundingRect should be trivially copyable." );
+	static_assert( sizeof( BoundingRect ) == 4 * sizeof( float ), "BoundingRect should be packed." );
 }
 }
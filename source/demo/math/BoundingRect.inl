@@ -82,6 +82,11 @@ inline namespace Math
 		return max - min;
 	}
 
+	inline BoundingRect BoundingRect::GetQuarter( const size_t index ) const
+	{
+		return { GetCenter(), GetCorner( index ) };
+	}
+
 	inline const size_t BoundingRect::GetNearestCornerIndex( const Vector2f& point ) const
 	{
 		const Vector2f direction{ point - GetCenter() };
@@ -107,8 +112,59 @@ inline namespace Math
 
 	inline const bool BoundingRect::IsIntersects( const Vector2f& center, const float radius ) const
 	{
-		const size_t corner_index = GetNearestCornerIndex( center );
-		return ( GetCorner( corner_index ) - center ).GetLength() <= radius;
+		const Vector2f nearest_point{ std::clamp( center.x, min.x, max.x ), std::clamp( center.y, min.y, max.y ) };
+		return ( nearest_point - center ).GetSquareLength() <= ( radius * radius );
+	}
+
+	inline const float BoundingRect::GetEntryTime( const Vector2f& origin, const Vector2f& displacement ) const
+	{
+		constexpr float INFINITE_TIME = std::numeric_limits<float>::infinity();
+		using Field = float Vector2f::*;
+
+		float entry_time	= 0.0f;
+		float exit_time		= 1.0f;
+		for( const Field field : { &Vector2f::x, &Vector2f::y } )
+		{
+			const float axis_origin			= origin.*field;
+			const float axis_displacement	= displacement.*field;
+
+			// Motion parallel to the slab never enters it, so division is avoided.
+			if( axis_displacement == 0.0f )
+			{
+				if( ( axis_origin < min.*field ) || ( axis_origin > max.*field ) )
+				{
+					return INFINITE_TIME;
+				}
+
+				continue;
+			}
+
+			const float min_time = ( min.*field - axis_origin ) / axis_displacement;
+			const float max_time = ( max.*field - axis_origin ) / axis_displacement;
+			entry_time	= std::max( entry_time, std::min( min_time, max_time ) );
+			exit_time	= std::min( exit_time, std::max( min_time, max_time ) );
+		}
+
+		return ( entry_time <= exit_time )? entry_time : INFINITE_TIME;
+	}
+
+	inline const float BoundingRect::GetSweepTime( const BoundingRect& obstacle, const Vector2f& displacement ) const
+	{
+		// The moving rect touches the obstacle when its center enters the obstacle, expanded by the size of moving rect.
+		const Vector2f half_size{ GetSize() * 0.5f };
+		const BoundingRect expanded_obstacle{ obstacle.min - half_size, obstacle.max + half_size, std::ignore };
+
+		return expanded_obstacle.GetEntryTime( GetCenter(), displacement );
+	}
+
+	inline const Containment BoundingRect::Classify( const BoundingRect& rect ) const
+	{
+		if( !IsIntersects( rect ) )
+		{
+			return Containment::Outside;
+		}
+
+		return ConsistsOf( rect )? Containment::Inside : Containment::Intersects;
 	}
 }
 }
@@ -0,0 +1,16 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Math
+{
+	// Result of classification of one area against another.
+	enum class Containment : uint8_t
+	{
+		Outside,	// Areas have no common points.
+		Intersects,	// Areas are partially intersecting.
+		Inside,		// Classified area lies totally inside of the other one.
+	};
+}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Math
+{
+	/**
+		@brief	Convex polygon in 2D space.
+
+		Polygon is described by its vertices. Vertices may be given in any winding order, but polygon always stores them counter-clockwise.
+		For each edge of polygon the outward normal and the projection range of polygon onto the normal are stored,
+		so the classification of rects is performed by the separating-axis test with no additional calculations.
+	*/
+	struct ConvexPolygon final
+	{
+		std::vector<Vector2f>	vertices;		// Vertices of polygon in counter-clockwise order.
+		std::vector<Vector2f>	normals;		// Outward normal of each edge. Edge `i` starts at vertex `i`.
+		std::vector<Vector2f>	projections;	// Range of polygon projection onto each normal, given as `( min, max )`.
+		BoundingRect			bounds;			// Bounding rect of polygon.
+
+
+		inline ConvexPolygon() noexcept							= default;
+		inline ConvexPolygon( const ConvexPolygon& )			= default;
+		inline ConvexPolygon( ConvexPolygon&& ) noexcept		= default;
+		inline ~ConvexPolygon() noexcept						= default;
+
+		inline explicit ConvexPolygon( std::vector<Vector2f> vertices );
+		inline explicit ConvexPolygon( const OrientedRect& rect );
+
+
+		inline ConvexPolygon& operator = ( const ConvexPolygon& )		= default;
+		inline ConvexPolygon& operator = ( ConvexPolygon&& ) noexcept	= default;
+
+
+		// Get the bounding rect of polygon.
+		inline const BoundingRect& GetBounds() const	{ return bounds; };
+
+
+		// Whether the point lies inside of polygon.
+		inline const bool ConsistsOf( const Vector2f& point ) const;
+
+		// Classify the rect against the polygon.
+		inline const Containment Classify( const BoundingRect& rect ) const;
+
+		// Whether the polygon intersects with given rect.
+		inline const bool IsIntersects( const BoundingRect& rect ) const;
+	};
+}
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Math
+{
+	inline ConvexPolygon::ConvexPolygon( std::vector<Vector2f> vertices )
+		: vertices{ std::move( vertices ) }
+	{
+		float doubled_area = 0.0f;
+		for( size_t index = 0; index < this->vertices.size(); ++index )
+		{
+			const Vector2f& current	= this->vertices[ index ];
+			const Vector2f& next	= this->vertices[ ( index + 1 ) % this->vertices.size() ];
+			doubled_area += ( current.x * next.y ) - ( next.x * current.y );
+		}
+
+		if( doubled_area < 0.0f )
+		{
+			std::reverse( this->vertices.begin(), this->vertices.end() );
+		}
+
+		normals.reserve( this->vertices.size() );
+		projections.reserve( this->vertices.size() );
+		for( size_t index = 0; index < this->vertices.size(); ++index )
+		{
+			const Vector2f edge{ this->vertices[ ( index + 1 ) % this->vertices.size() ] - this->vertices[ index ] };
+			const Vector2f& normal = normals.emplace_back( edge.y, -edge.x );
+
+			Vector2f projection{ std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest() };
+			for( const Vector2f& vertex : this->vertices )
+			{
+				const float distance = Dot( normal, vertex );
+				projection.x = std::min( projection.x, distance );
+				projection.y = std::max( projection.y, distance );
+			}
+
+			projections.push_back( projection );
+		}
+
+		if( !this->vertices.empty() )
+		{
+			bounds = BoundingRect{ this->vertices.front() };
+			for( const Vector2f& vertex : this->vertices )
+			{
+				bounds.Grow( vertex );
+			}
+		}
+	}
+
+	inline ConvexPolygon::ConvexPolygon( const OrientedRect& rect )
+		: ConvexPolygon{ { rect.GetCorner( 0 ), rect.GetCorner( 1 ), rect.GetCorner( 2 ), rect.GetCorner( 3 ) } }
+	{
+	}
+
+	inline const bool ConvexPolygon::ConsistsOf( const Vector2f& point ) const
+	{
+		for( size_t index = 0; index < normals.size(); ++index )
+		{
+			if( Dot( normals[ index ], point ) > projections[ index ].y )
+			{
+				return false;
+			}
+		}
+
+		return !vertices.empty();
+	}
+
+	inline const Containment ConvexPolygon::Classify( const BoundingRect& rect ) const
+	{
+		// Axes of rect are the first to be tested.
+		const Containment rect_containment = rect.Classify( bounds );
+		if( rect_containment == Containment::Outside )
+		{
+			return Containment::Outside;
+		}
+
+		const Vector2f rect_center{ rect.GetCenter() };
+		const Vector2f rect_extents{ rect.GetSize() * 0.5f };
+
+		bool is_inside = true;
+		for( size_t index = 0; index < normals.size(); ++index )
+		{
+			const Vector2f& normal		= normals[ index ];
+			const Vector2f& projection	= projections[ index ];
+
+			const float center_distance	= Dot( normal, rect_center );
+			const float radius			= ( std::abs( normal.x ) * rect_extents.x ) + ( std::abs( normal.y ) * rect_extents.y );
+			if( ( ( center_distance - radius ) > projection.y ) || ( ( center_distance + radius ) < projection.x ) )
+			{
+				return Containment::Outside;
+			}
+
+			is_inside = is_inside && ( ( center_distance + radius ) <= projection.y );
+		}
+
+		return is_inside? Containment::Inside : Containment::Intersects;
+	}
+
+	inline const bool ConvexPolygon::IsIntersects( const BoundingRect& rect ) const
+	{
+		return Classify( rect ) != Containment::Outside;
+	}
+}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Math
+{
+	/**
+		@brief	Oriented Bounding Rect in 2D space.
+
+		Oriented rect is represented by the center point, half of its size and the direction of its local X axis.
+		Local Y axis is always perpendicular to local X axis, counter-clockwise.
+	*/
+	struct OrientedRect final
+	{
+		// Count of corners in rect. It helps to get rid of magic numbers in code.
+		static constexpr size_t CORNERS_COUNT = 4;
+
+
+		Vector2f	center;					// Center point of rect.
+		Vector2f	half_size;				// Half of rect size along the local axes.
+		Vector2f	axis{ 1.0f, 0.0f };		// Unit direction of local X axis.
+
+
+		inline OrientedRect() noexcept							= default;
+		inline OrientedRect( const OrientedRect& ) noexcept		= default;
+		inline ~OrientedRect() noexcept							= default;
+
+		inline OrientedRect( const Vector2f& center, const Vector2f& half_size, const float angle ) noexcept;
+
+
+		inline OrientedRect& operator = ( const OrientedRect& ) noexcept	= default;
+
+
+		// Get the corner point by index. Corners are indexed counter-clockwise, starting from the `( -x, -y )` local corner.
+		inline Vector2f GetCorner( const size_t index ) const;
+
+		// Get the bounding rect of oriented rect.
+		inline BoundingRect GetBounds() const;
+	};
+}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Math
+{
+	inline OrientedRect::OrientedRect( const Vector2f& center, const Vector2f& half_size, const float angle ) noexcept
+		: center{ center }
+		, half_size{ half_size }
+		, axis{ std::cos( angle ), std::sin( angle ) }
+	{
+	}
+
+	inline Vector2f OrientedRect::GetCorner( const size_t index ) const
+	{
+		constexpr std::pair<float, float> corner_signs[ CORNERS_COUNT ] { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f } };
+
+		const Vector2f perpendicular{ -axis.y, axis.x };
+		const auto [ x_sign, y_sign ] = corner_signs[ index ];
+		return center + axis * ( x_sign * half_size.x ) + perpendicular * ( y_sign * half_size.y );
+	}
+
+	inline BoundingRect OrientedRect::GetBounds() const
+	{
+		BoundingRect result{ GetCorner( 0 ) };
+		for( size_t index = 1; index < CORNERS_COUNT; ++index )
+		{
+			result.Grow( GetCorner( index ) );
+		}
+
+		return result;
+	}
+}
+}
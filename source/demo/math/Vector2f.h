@@ -10,7 +10,7 @@ inline namespace Math
 
 		Vector represents the `(x, y)` point or direction in 2D space.
 		It also provide some subset of functions that necessary for this project.
-		Vector instances are swappable.
+		Vector instances are swappable and trivially copyable, so the collections of vectors may be copied as plain memory.
 	*/
 	struct Vector2f final
 	{
@@ -28,14 +28,14 @@ inline namespace Math
 
 		inline Vector2f() noexcept						= default;
 		inline Vector2f( const Vector2f& ) noexcept		= default;
-		inline Vector2f( Vector2f&& other ) noexcept	: x{ std::exchange( other.x, NAN_VALUE ) }, y{ std::exchange( other.y, NAN_VALUE ) } {};
+		inline Vector2f( Vector2f&& ) noexcept			= default;
 		inline ~Vector2f() noexcept						= default;
 
 		inline Vector2f( const float x, const float y ) noexcept	: x{ x }, y{ y } {};
 
 
 		inline Vector2f& operator = ( const Vector2f& ) noexcept	= default;
-		inline Vector2f& operator = ( Vector2f&& other ) noexcept	{ Vector2f{ std::move( other ) }.Swap( *this ); return *this; };
+		inline Vector2f& operator = ( Vector2f&& ) noexcept		= default;
 
 
 		// Performs the value swapping.
@@ -61,5 +61,9 @@ inline namespace Math
 		// Calculates the length of vector.
 		inline const float GetLength() const;
 	};
+
+
+	static_assert( std::is_trivially_copyable_v<Vector2f>, "Vector2f should be trivially copyable." );
+	static_assert( sizeof( Vector2f ) == 2 * sizeof( float ), "Vector2f should be packed." );
 }
 }
\ No newline at end of file
@@ -33,5 +33,11 @@ inline namespace Math
 	{
 		return { left.x * value, left.y * value };
 	}
+
+	// Calculates the dot product of vectors.
+	inline const float Dot( const Vector2f& left, const Vector2f& right )
+	{
+		return ( left.x * right.x ) + ( left.y * right.y );
+	}
 }
 }
@@ -2,10 +2,25 @@
 
 
 // Most fundamental dependencies.
+#include <algorithm>
 #include <cstdint>
 #include <cmath>
+#include <limits>
 #include <tuple>
+#include <type_traits>
 #include <utility>
+#include <vector>
+
+// SIMD instructions. SSE2 is always available on x64 targets.
+#if defined( _M_X64 ) || defined( __SSE2__ )
+	#include <emmintrin.h>
+	#define DEMO_MATH_SSE2
+#endif
+
+#if defined( DEMO_MATH_SSE2 ) && defined( __AVX__ )
+	#include <immintrin.h>
+	#define DEMO_MATH_AVX
+#endif
 
 
 // Namespace definition.
@@ -24,11 +39,18 @@ namespace Internal
 
 
 // Public definitions.
+#include "Containment.h"
 #include "Vector2f.h"
 #include "BoundingRect.h"
+#include "OrientedRect.h"
+#include "ConvexPolygon.h"
+#include "BatchMath.h"
 
 // Deferred inline definitions.
 #include "Vector2f.operations.inl"
 
 #include "BoundingRect.inl"
+#include "OrientedRect.inl"
+#include "ConvexPolygon.inl"
+#include "BatchMath.inl"
 #include "Vector2f.inl"
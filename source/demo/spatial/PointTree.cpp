@@ -0,0 +1,408 @@
+#include <demo/spatial/spatial.h>
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+namespace
+{
+	// Count of points tested at once.
+	constexpr size_t BATCH_SIZE = 4;
+
+
+	// Rectangular area of searching.
+	struct RectArea final
+	{
+		const BoundingRect& bounds; // Bounds of area.
+
+
+		// Whether the area intersects with given rect.
+		inline const bool IsIntersects( const BoundingRect& rect ) const	{ return bounds.IsIntersects( rect ); };
+
+		// Whether the given rect lies totally inside the area.
+		inline const bool ConsistsOf( const BoundingRect& rect ) const		{ return bounds.ConsistsOf( rect ); };
+
+		// Whether the point lies inside the area.
+		inline const bool ConsistsOf( const float x, const float y ) const	{ return bounds.ConsistsOf( Vector2f{ x, y } ); };
+
+		// Test the batch of points. Returns the mask of points inside the area, where the lowest bit corresponds to the first point.
+		inline const uint32_t TestBatch( const float* xs, const float* ys ) const
+		{
+		#if defined( DEMO_MATH_SSE2 )
+			const __m128 x = _mm_loadu_ps( xs );
+			const __m128 y = _mm_loadu_ps( ys );
+
+			const __m128 inside_x = _mm_and_ps( _mm_cmpge_ps( x, _mm_set1_ps( bounds.min.x ) ), _mm_cmple_ps( x, _mm_set1_ps( bounds.max.x ) ) );
+			const __m128 inside_y = _mm_and_ps( _mm_cmpge_ps( y, _mm_set1_ps( bounds.min.y ) ), _mm_cmple_ps( y, _mm_set1_ps( bounds.max.y ) ) );
+			return uint32_t( _mm_movemask_ps( _mm_and_ps( inside_x, inside_y ) ) );
+		#else
+			uint32_t mask = 0;
+			for( size_t index = 0; index < BATCH_SIZE; ++index )
+			{
+				mask |= uint32_t( ConsistsOf( xs[ index ], ys[ index ] ) ) << index;
+			}
+
+			return mask;
+		#endif
+		}
+	};
+
+	// Circular area of searching.
+	struct CircleArea final
+	{
+		const Vector2f&	center; // Center of circle.
+		const float		radius; // Radius of circle.
+
+
+		// Whether the area intersects with given rect.
+		inline const bool IsIntersects( const BoundingRect& rect ) const	{ return rect.IsIntersects( center, radius ); };
+
+		// Whether the given rect lies totally inside the area. It is so, when the farthest corner of rect lies inside the circle.
+		inline const bool ConsistsOf( const BoundingRect& rect ) const
+		{
+			const Vector2f farthest_offset{
+				std::max( std::abs( rect.min.x - center.x ), std::abs( rect.max.x - center.x ) ),
+				std::max( std::abs( rect.min.y - center.y ), std::abs( rect.max.y - center.y ) )
+			};
+
+			return farthest_offset.GetSquareLength() <= radius * radius;
+		}
+
+		// Whether the point lies inside the area.
+		inline const bool ConsistsOf( const float x, const float y ) const	{ return ( Vector2f{ x, y } - center ).GetSquareLength() <= radius * radius; };
+
+		// Test the batch of points. Returns the mask of points inside the area, where the lowest bit corresponds to the first point.
+		inline const uint32_t TestBatch( const float* xs, const float* ys ) const
+		{
+		#if defined( DEMO_MATH_SSE2 )
+			const __m128 offset_x = _mm_sub_ps( _mm_loadu_ps( xs ), _mm_set1_ps( center.x ) );
+			const __m128 offset_y = _mm_sub_ps( _mm_loadu_ps( ys ), _mm_set1_ps( center.y ) );
+
+			const __m128 square_distance = _mm_add_ps( _mm_mul_ps( offset_x, offset_x ), _mm_mul_ps( offset_y, offset_y ) );
+			return uint32_t( _mm_movemask_ps( _mm_cmple_ps( square_distance, _mm_set1_ps( radius * radius ) ) ) );
+		#else
+			uint32_t mask = 0;
+			for( size_t index = 0; index < BATCH_SIZE; ++index )
+			{
+				mask |= uint32_t( ConsistsOf( xs[ index ], ys[ index ] ) ) << index;
+			}
+
+			return mask;
+		#endif
+		}
+	};
+
+
+	// Visit each point of leaf, which lies inside the area. Points are tested in batches, the rest of points is tested one by one.
+	template< typename TArea, typename TVisitor >
+	void VisitLeaf( const Internal::PointQuad& quad, const TArea& area, TVisitor&& visitor )
+	{
+		const size_t points_count = quad.tags.size();
+
+		size_t index = 0;
+		for( ; index + BATCH_SIZE <= points_count; index += BATCH_SIZE )
+		{
+			const uint32_t mask = area.TestBatch( quad.xs.data() + index, quad.ys.data() + index );
+			for( size_t offset = 0; offset < BATCH_SIZE; ++offset )
+			{
+				if( ( mask & ( 1U << offset ) ) != 0 )
+				{
+					visitor( quad, index + offset );
+				}
+			}
+		}
+
+		for( ; index < points_count; ++index )
+		{
+			if( area.ConsistsOf( quad.xs[ index ], quad.ys[ index ] ) )
+			{
+				visitor( quad, index );
+			}
+		}
+	}
+}
+
+
+	void PointTree::Insert( const Vector2f& point, const size_t tag )
+	{
+		if( m_quads.empty() )
+		{
+			Rebuild( BoundingRect{ point } );
+		}
+		else if( !m_bounds.ConsistsOf( point ) )
+		{
+			// Bounds are grown with the margin of half size at each side, so the rebuilding is amortized.
+			BoundingRect bounds{ m_bounds };
+			bounds.Grow( point );
+
+			const Vector2f margin{ bounds.GetSize() * 0.5f };
+			Rebuild( { bounds.min - margin, bounds.max + margin, std::ignore } );
+		}
+
+		InsertPoint( 0, point, tag );
+	}
+
+	const bool PointTree::Remove( const Vector2f& point, const size_t tag )
+	{
+		if( m_quads.empty() )
+		{
+			return false;
+		}
+
+		const size_t leaf_index	= GetLeafIndex( point );
+		const size_t slot_index	= GetSlotIndex( leaf_index, tag );
+
+		Internal::PointQuad& leaf = m_quads[ leaf_index ];
+		if( slot_index == leaf.tags.size() )
+		{
+			return false;
+		}
+
+		std::swap( leaf.xs[ slot_index ], leaf.xs.back() );
+		std::swap( leaf.ys[ slot_index ], leaf.ys.back() );
+		std::swap( leaf.tags[ slot_index ], leaf.tags.back() );
+		leaf.xs.pop_back();
+		leaf.ys.pop_back();
+		leaf.tags.pop_back();
+
+		for( size_t quad_index = 0; ; quad_index = m_quads[ quad_index ].first_quarter + m_quads[ quad_index ].bounds.GetNearestCornerIndex( point ) )
+		{
+			--m_quads[ quad_index ].points_count;
+			if( quad_index == leaf_index )
+			{
+				return true;
+			}
+		}
+	}
+
+	const bool PointTree::Move( const Vector2f& previous_point, const Vector2f& point, const size_t tag )
+	{
+		if( m_quads.empty() )
+		{
+			return false;
+		}
+
+		// The point, which stays in the same leaf, is just updated in place.
+		const size_t leaf_index = GetLeafIndex( previous_point );
+		if( m_bounds.ConsistsOf( point ) && ( GetLeafIndex( point ) == leaf_index ) )
+		{
+			Internal::PointQuad& leaf = m_quads[ leaf_index ];
+
+			const size_t slot_index = GetSlotIndex( leaf_index, tag );
+			if( slot_index == leaf.tags.size() )
+			{
+				return false;
+			}
+
+			leaf.xs[ slot_index ] = point.x;
+			leaf.ys[ slot_index ] = point.y;
+			return true;
+		}
+
+		if( !Remove( previous_point, tag ) )
+		{
+			return false;
+		}
+
+		Insert( point, tag );
+		return true;
+	}
+
+	PointTree::QueryResult PointTree::Find( const BoundingRect& bounds ) const
+	{
+		QueryResult result{ Internal::GetQueryResource() };
+		VisitPoints( RectArea{ bounds }, [&result]( const Internal::PointQuad& quad, const size_t index ) { result.push_back( quad.tags[ index ] ); } );
+
+		return result;
+	}
+
+	PointTree::QueryResult PointTree::Find( const Vector2f& center, const float radius ) const
+	{
+		QueryResult result{ Internal::GetQueryResource() };
+		VisitPoints( CircleArea{ center, radius }, [&result]( const Internal::PointQuad& quad, const size_t index ) { result.push_back( quad.tags[ index ] ); } );
+
+		return result;
+	}
+
+	const size_t PointTree::Count( const BoundingRect& bounds ) const
+	{
+		if( m_quads.empty() || !bounds.IsIntersects( m_bounds ) )
+		{
+			return 0;
+		}
+
+		size_t result = 0;
+
+		std::pmr::vector<size_t> pending_quads{ Internal::GetQueryResource() };
+		pending_quads.push_back( 0 );
+		while( !pending_quads.empty() )
+		{
+			const Internal::PointQuad& quad = m_quads[ pending_quads.back() ];
+			pending_quads.pop_back();
+
+			// The whole subtree of quad, which lies inside the bounds, is counted at once.
+			if( bounds.ConsistsOf( quad.bounds ) )
+			{
+				result += quad.points_count;
+				continue;
+			}
+
+			if( quad.first_quarter == 0 )
+			{
+				VisitLeaf( quad, RectArea{ bounds }, [&result]( const Internal::PointQuad&, const size_t ) { ++result; } );
+				continue;
+			}
+
+			for( size_t quarter_index = quad.first_quarter; quarter_index < quad.first_quarter + BoundingRect::CORNERS_COUNT; ++quarter_index )
+			{
+				if( ( m_quads[ quarter_index ].points_count > 0 ) && bounds.IsIntersects( m_quads[ quarter_index ].bounds ) )
+				{
+					pending_quads.push_back( quarter_index );
+				}
+			}
+		}
+
+		return result;
+	}
+
+	void PointTree::Rebuild( const BoundingRect& bounds )
+	{
+		std::vector<Internal::PointQuad> quads{ std::exchange( m_quads, {} ) };
+
+		m_bounds = bounds;
+		m_quads.push_back( { {}, {}, {}, bounds, 1 } );
+
+		for( const auto& quad : quads )
+		{
+			for( size_t index = 0; index < quad.tags.size(); ++index )
+			{
+				InsertPoint( 0, { quad.xs[ index ], quad.ys[ index ] }, quad.tags[ index ] );
+			}
+		}
+	}
+
+	void PointTree::InsertPoint( size_t quad_index, const Vector2f& point, const size_t tag )
+	{
+		for( ;; )
+		{
+			Internal::PointQuad& quad = m_quads[ quad_index ];
+			if( quad.first_quarter != 0 )
+			{
+				++quad.points_count;
+				quad_index = quad.first_quarter + quad.bounds.GetNearestCornerIndex( point );
+				continue;
+			}
+
+			if( ( quad.tags.size() < MAX_POINTS ) || ( quad.level >= MAX_LEVELS ) )
+			{
+				++quad.points_count;
+				quad.xs.push_back( point.x );
+				quad.ys.push_back( point.y );
+				quad.tags.push_back( tag );
+				return;
+			}
+
+			// The quad turns into subtree, so the point will be placed to one of its quarters.
+			SplitToQuarters( quad_index );
+		}
+	}
+
+	void PointTree::SplitToQuarters( const size_t quad_index )
+	{
+		const size_t first_quarter = m_quads.size();
+		for( size_t quarter_index = 0; quarter_index < BoundingRect::CORNERS_COUNT; ++quarter_index )
+		{
+			const Internal::PointQuad& quad = m_quads[ quad_index ];
+			m_quads.push_back( { {}, {}, {}, quad.bounds.GetQuarter( quarter_index ), quad.level + 1 } );
+		}
+
+		Internal::PointQuad& quad = m_quads[ quad_index ];
+		quad.first_quarter = first_quarter;
+
+		for( size_t index = 0; index < quad.tags.size(); ++index )
+		{
+			Internal::PointQuad& quarter = m_quads[ first_quarter + quad.bounds.GetNearestCornerIndex( { quad.xs[ index ], quad.ys[ index ] } ) ];
+			quarter.xs.push_back( quad.xs[ index ] );
+			quarter.ys.push_back( quad.ys[ index ] );
+			quarter.tags.push_back( quad.tags[ index ] );
+			++quarter.points_count;
+		}
+
+		// Subtrees store no points.
+		quad.xs		= {};
+		quad.ys		= {};
+		quad.tags	= {};
+	}
+
+	const size_t PointTree::GetLeafIndex( const Vector2f& point ) const
+	{
+		size_t quad_index = 0;
+		while( m_quads[ quad_index ].first_quarter != 0 )
+		{
+			const Internal::PointQuad& quad = m_quads[ quad_index ];
+			quad_index = quad.first_quarter + quad.bounds.GetNearestCornerIndex( point );
+		}
+
+		return quad_index;
+	}
+
+	const size_t PointTree::GetSlotIndex( const size_t leaf_index, const size_t tag ) const
+	{
+		const auto& tags = m_quads[ leaf_index ].tags;
+		return size_t( std::distance( tags.begin(), std::find( tags.begin(), tags.end(), tag ) ) );
+	}
+
+	template< typename TArea, typename TVisitor >
+	void PointTree::VisitPoints( const TArea& area, TVisitor&& visitor ) const
+	{
+		if( m_quads.empty() || !area.IsIntersects( m_bounds ) )
+		{
+			return;
+		}
+
+		// Quad to be visited, along with the sign of its subtree lying inside the area.
+		struct PendingQuad final
+		{
+			size_t	index;
+			bool	is_inside;
+		};
+
+		std::pmr::vector<PendingQuad> pending_quads{ { { 0, area.ConsistsOf( m_bounds ) } }, Internal::GetQueryResource() };
+		while( !pending_quads.empty() )
+		{
+			const auto [ quad_index, is_inside ] = pending_quads.back();
+			pending_quads.pop_back();
+
+			const Internal::PointQuad& quad = m_quads[ quad_index ];
+			if( quad.first_quarter == 0 )
+			{
+				if( !is_inside )
+				{
+					VisitLeaf( quad, area, visitor );
+					continue;
+				}
+
+				// The whole leaf inside the area is visited with no tests.
+				for( size_t index = 0; index < quad.tags.size(); ++index )
+				{
+					visitor( quad, index );
+				}
+
+				continue;
+			}
+
+			for( size_t quarter_index = quad.first_quarter; quarter_index < quad.first_quarter + BoundingRect::CORNERS_COUNT; ++quarter_index )
+			{
+				const Internal::PointQuad& quarter = m_quads[ quarter_index ];
+				if( ( quarter.points_count == 0 ) || ( !is_inside && !area.IsIntersects( quarter.bounds ) ) )
+				{
+					continue;
+				}
+
+				pending_quads.push_back( { quarter_index, is_inside || area.ConsistsOf( quarter.bounds ) } );
+			}
+		}
+	}
+}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+	/**
+		@brief	Quad tree, specialized for points.
+
+		Point tree indexes the points of zero extent. Each point is stored just as two components and the tag, right in the leaf of tree.
+		There is no shape instances, so the point is referenced only by its tag and position. Tags are expected to be unique.
+		Subtrees never store the points, since each point always fits a single quarter. So the point is always found in a leaf.
+		Points of leaf are tested in batches, using SIMD instructions where they are available.
+
+		This tree automatically grows the bounds of indexing. Bounds are grown with margin and the tree is rebuilt then.
+		This implementation carries no thread safety. So it should be guarded externally to allow the thread-safe usage.
+	*/
+	class PointTree final
+	{
+	// Public constants.
+	public:
+		// Maximum points stored by single leaf before split it to quarters.
+		static constexpr size_t MAX_POINTS = 16;
+
+		// Maximum level of tree depth before the quarters splitting will be stopped.
+		static constexpr size_t MAX_LEVELS = 16;
+
+	// Public inner types.
+	public:
+		// Collection of tags of found points. Memory of collection is provided by the query arena installed with `QueryArenaScope`.
+		using QueryResult = std::pmr::vector<size_t>;
+
+	// Public interface.
+	public:
+		// Insert the point with given tag.
+		void Insert( const Vector2f& point, const size_t tag );
+
+		// Remove the point with given tag. Returns whether the point was found.
+		const bool Remove( const Vector2f& point, const size_t tag );
+
+		// Move the point with given tag from `previous_point` to `point`. Returns whether the point was found.
+		const bool Move( const Vector2f& previous_point, const Vector2f& point, const size_t tag );
+
+
+		// Perform the spatial searching of points in given bounds.
+		QueryResult Find( const BoundingRect& bounds ) const;
+
+		// Perform the spatial searching of points in given circle.
+		QueryResult Find( const Vector2f& center, const float radius ) const;
+
+		// Count the points in given bounds. Subtrees inside the bounds are counted with no enumeration of points.
+		const size_t Count( const BoundingRect& bounds ) const;
+
+
+		// Get the count of indexed points.
+		inline const size_t GetPointsCount() const		{ return m_quads.empty()? 0 : m_quads.front().points_count; };
+
+		// Get the bounds of indexing.
+		inline const BoundingRect& GetBounds() const	{ return m_bounds; };
+
+	// Private interface.
+	private:
+		// Rebuild the tree within the given bounds.
+		void Rebuild( const BoundingRect& bounds );
+
+		// Insert the point into the subtree of quad by given index.
+		void InsertPoint( size_t quad_index, const Vector2f& point, const size_t tag );
+
+		// Split the leaf by given index to quarters.
+		void SplitToQuarters( const size_t quad_index );
+
+		// Get the index of leaf, where the given point is placed.
+		const size_t GetLeafIndex( const Vector2f& point ) const;
+
+		// Get the index of slot in leaf, where the point with given tag is stored. Returns the count of points in leaf, if the point is absent.
+		const size_t GetSlotIndex( const size_t leaf_index, const size_t tag ) const;
+
+
+		// Visit each point inside the area. The area should be able to intersect the bounding rects and to test the batches of points.
+		// Visitor receives the leaf and the index of point in it.
+		template< typename TArea, typename TVisitor >
+		void VisitPoints( const TArea& area, TVisitor&& visitor ) const;
+
+	// Private state.
+	private:
+		std::vector<Internal::PointQuad>	m_quads;					// Quads of tree. The root is the first one.
+		BoundingRect						m_bounds{ { 0.0f, 0.0f } };	// The indexing area.
+	};
+}
+}
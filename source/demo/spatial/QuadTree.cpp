@@ -7,40 +7,360 @@ namespace Demo
 {
 inline namespace Spatial
 {
+	QuadTree::QuadTree( const IndexKind index_kind )
+	{
+		if( index_kind == IndexKind::Grid )
+		{
+			m_index.emplace<Internal::GridIndex>();
+		}
+	}
+
+	QuadTree::QuadTree( const BoundingRect& bounds, const IndexKind index_kind )
+		: QuadTree{ index_kind }
+	{
+		m_bounds = bounds;
+	}
+
+	void QuadTree::Join( const QuadTree& left, const QuadTree& right, const JoinCallback& callback, const size_t threads_count )
+	{
+		// Both indexes should be built before the joining.
+		left.VisitBuiltIndex( []( auto& ) {} );
+		right.VisitBuiltIndex( []( auto& ) {} );
+
+		const auto left_tree = std::get_if<Internal::IndexTree>( &left.m_index );
+		const auto right_tree = std::get_if<Internal::IndexTree>( &right.m_index );
+		if( ( left_tree != nullptr ) && ( right_tree != nullptr ) )
+		{
+			left_tree->Join( *right_tree, callback, threads_count );
+			return;
+		}
+
+		// Indexes are searched directly, so the joining is not recorded as searching.
+		const QueryResult right_shapes{ right.VisitBuiltIndex( [&right]( auto& index ) { return index.Find( right.GetBounds() ); } ) };
+		for( const auto right_shape : right_shapes )
+		{
+			const BoundingRect& bounds = right_shape->GetBounds();
+			for( const auto left_shape : left.VisitBuiltIndex( [&bounds]( auto& index ) { return index.Find( bounds ); } ) )
+			{
+				callback( *left_shape, *right_shape );
+			}
+		}
+	}
+
 	QuadTree::SharedShape QuadTree::Acquire( const BoundingRect& bounds )
 	{
 		const auto [ shape, handle ] = m_shape_provider.Create( *this, bounds );
-		if( !m_bounds.ConsistsOf( bounds ) )
+		PushShape( *shape );
+		NotifySubscriptions( *shape, std::nullopt, bounds );
+
+		if( m_trace_recorder != nullptr )
 		{
-			m_bounds.Grow( bounds );
-			m_tree.Reset();
+			m_trace_recorder->RecordAcquire( *shape );
 		}
 
-		m_tree.Push( *shape );
-
 		return { shape, [this, handle = handle]( Shape* shape ){ ReleaseShape( handle, shape ); } };
 	}
 
-	std::vector<const QuadTree::Shape*> QuadTree::Find( const BoundingRect& bounds ) const
+	QuadTree::SharedSubscription QuadTree::Subscribe( const BoundingRect& bounds )
+	{
+		return std::make_shared<Subscription>( *this, bounds );
+	}
+
+	QuadTree::QueryResult QuadTree::Find( const BoundingRect& bounds ) const
+	{
+		RecordFind( [&bounds]( auto& event ) { event.operation = TraceRecorder::Operation::Find; event.bounds = bounds; } );
+
+		return VisitBuiltIndex( [&bounds]( auto& index ) { return index.Find( bounds ); } );
+	}
+
+	QuadTree::QueryResult QuadTree::Find( const Vector2f& center, const float radius ) const
+	{
+		RecordFind(
+			[&center, radius]( auto& event )
+			{
+				event.operation	= TraceRecorder::Operation::FindCircle;
+				event.bounds	= BoundingRect{ center };
+				event.radius	= radius;
+			}
+		);
+
+		return FindInCircle( center, radius );
+	}
+
+	QuadTree::QueryResult QuadTree::Find( const BoundingRect& bounds, QueryHint& hint ) const
 	{
-		if( m_tree.IsEmpty() )
+		RecordFind(
+			[this, &bounds, &hint]( auto& event )
+			{
+				event.operation	= TraceRecorder::Operation::FindHinted;
+				event.shape_id	= m_trace_recorder->GetHintId( hint );
+				event.bounds	= bounds;
+			}
+		);
+
+		return VisitBuiltIndex(
+			[&bounds, &hint]( auto& index )
+			{
+				if constexpr( std::is_same_v<std::decay_t<decltype( index )>, Internal::IndexTree> )
+				{
+					return index.Find( bounds, hint );
+				}
+				else
+				{
+					return index.Find( bounds );
+				}
+			}
+		);
+	}
+
+	QuadTree::QueryResult QuadTree::Find( const BoundingRect& bounds, const uint64_t categories ) const
+	{
+		RecordFind(
+			[&bounds, categories]( auto& event )
+			{
+				event.operation		= TraceRecorder::Operation::FindCategories;
+				event.bounds		= bounds;
+				event.categories	= categories;
+			}
+		);
+
+		if( categories == Shape::ALL_CATEGORIES )
 		{
-			m_tree.Build( m_bounds );
+			return VisitBuiltIndex( [&bounds]( auto& index ) { return index.Find( bounds ); } );
 		}
 
-		return m_tree.Find( bounds );
+		return VisitBuiltIndex( [&bounds, categories]( auto& index ) { return index.Find( bounds, categories ); } );
 	}
 
-	std::vector<const QuadTree::Shape*> QuadTree::Find( const Vector2f& center, const float radius ) const
+	QuadTree::QueryResult QuadTree::FindChangedSince( const BoundingRect& bounds, const uint64_t epoch ) const
 	{
-		std::vector<const Shape*> result{ Find( BoundingRect{ center }.Resize( radius ) ) };
+		RecordFind(
+			[&bounds, epoch]( auto& event )
+			{
+				event.operation	= TraceRecorder::Operation::FindChangedSince;
+				event.bounds	= bounds;
+				event.epoch		= epoch;
+			}
+		);
+
+		return VisitBuiltIndex( [&bounds, epoch]( auto& index ) { return index.FindChangedSince( bounds, epoch ); } );
+	}
+
+	QuadTree::QueryResult QuadTree::Find( const ConvexPolygon& polygon ) const
+	{
+		RecordFind( [&polygon]( auto& event ) { event.operation = TraceRecorder::Operation::FindPolygon; event.vertices = polygon.vertices; } );
+
+		return VisitBuiltIndex( [&polygon]( auto& index ) { return index.Find( polygon ); } );
+	}
+
+	QuadTree::QueryResult QuadTree::Find( const OrientedRect& rect ) const
+	{
+		return Find( ConvexPolygon{ rect } );
+	}
+
+	QuadTree::QueryResult QuadTree::Find( const BoundingRect& bounds, const QueryOptions& options ) const
+	{
+		RecordFind(
+			[&bounds, &options]( auto& event )
+			{
+				event.operation	= TraceRecorder::Operation::FindOrdered;
+				event.bounds	= bounds;
+				event.options	= options;
+			}
+		);
+
+		QueryResult result{ VisitBuiltIndex( [&bounds]( auto& index ) { return index.Find( bounds ); } ) };
+		Internal::OrderResult( result, options );
+
+		return result;
+	}
+
+	QuadTree::QueryResult QuadTree::Find( const Vector2f& center, const float radius, const QueryOptions& options ) const
+	{
+		RecordFind(
+			[&center, radius, &options]( auto& event )
+			{
+				event.operation	= TraceRecorder::Operation::FindCircleOrdered;
+				event.bounds	= BoundingRect{ center };
+				event.radius	= radius;
+				event.options	= options;
+			}
+		);
+
+		QueryResult result{ FindInCircle( center, radius ) };
+		Internal::OrderResult( result, options );
+
+		return result;
+	}
+
+	QuadTree::SweepResult QuadTree::FindSwept( const BoundingRect& bounds, const Vector2f& displacement, const bool is_first_hit_only ) const
+	{
+		RecordFind(
+			[&bounds, &displacement, is_first_hit_only]( auto& event )
+			{
+				event.operation			= TraceRecorder::Operation::FindSwept;
+				event.bounds			= bounds;
+				event.displacement		= displacement;
+				event.is_first_hit_only	= is_first_hit_only;
+			}
+		);
+
+		return VisitBuiltIndex(
+			[&bounds, &displacement, is_first_hit_only]( auto& index ) { return index.FindSwept( bounds, displacement, is_first_hit_only ); }
+		);
+	}
+
+	const bool QuadTree::Any( const BoundingRect& bounds ) const
+	{
+		RecordFind( [&bounds]( auto& event ) { event.operation = TraceRecorder::Operation::Any; event.bounds = bounds; } );
+
+		return VisitBuiltIndex( [&bounds]( auto& index ) { return index.Any( bounds ); } );
+	}
+
+	const size_t QuadTree::Count( const BoundingRect& bounds ) const
+	{
+		RecordFind( [&bounds]( auto& event ) { event.operation = TraceRecorder::Operation::Count; event.bounds = bounds; } );
+
+		return VisitBuiltIndex( [&bounds]( auto& index ) { return index.Count( bounds ); } );
+	}
+
+	QuadTree::QueryResult QuadTree::FindTop( const BoundingRect& bounds, const size_t count, const SizeKey key ) const
+	{
+		return FindTop( bounds, count, key, std::numeric_limits<size_t>::max() );
+	}
+
+	QuadTree::QueryResult QuadTree::FindTop( const BoundingRect& bounds, const size_t count, const SizeKey key, const size_t visits_budget ) const
+	{
+		RecordFind(
+			[&bounds, count, key, visits_budget]( auto& event )
+			{
+				event.operation		= TraceRecorder::Operation::FindTop;
+				event.bounds		= bounds;
+				event.count			= count;
+				event.key			= key;
+				event.visits_budget	= visits_budget;
+			}
+		);
+
+		return VisitBuiltIndex( [&bounds, count, key, visits_budget]( auto& index ) { return index.FindTop( bounds, count, key, visits_budget ); } );
+	}
+
+	QuadTree::HistogramResult QuadTree::Histogram( const BoundingRect& bounds, const size_t columns, const size_t rows ) const
+	{
+		RecordFind(
+			[&bounds, columns, rows]( auto& event )
+			{
+				event.operation	= TraceRecorder::Operation::Histogram;
+				event.bounds	= bounds;
+				event.columns	= columns;
+				event.rows		= rows;
+			}
+		);
+
+		return VisitBuiltIndex( [&bounds, columns, rows]( auto& index ) { return index.Histogram( bounds, columns, rows ); } );
+	}
+
+	void QuadTree::Optimize()
+	{
+		VisitBuiltIndex(
+			[]( auto& index )
+			{
+				if constexpr( std::is_same_v<std::decay_t<decltype( index )>, Internal::IndexTree> )
+				{
+					index.Optimize();
+				}
+			}
+		);
+	}
+
+	void QuadTree::SetConcurrentUpdates( const bool is_enabled )
+	{
+		m_is_concurrent_updates = is_enabled;
+		if( auto tree = std::get_if<Internal::IndexTree>( &m_index ) )
+		{
+			tree->SetConcurrentUpdates( is_enabled );
+		}
+
+		if( is_enabled || m_staged_shapes.empty() )
+		{
+			return;
+		}
+
+		// Indexing bounds grow once for all the staged shapes.
+		for( const auto shape : m_staged_shapes )
+		{
+			m_bounds.Grow( shape->GetBounds() );
+		}
+
+		std::visit( []( auto& index ) { index.Reset(); }, m_index );
+		for( const auto shape : std::exchange( m_staged_shapes, {} ) )
+		{
+			std::visit( [shape]( auto& index ) { index.Push( *shape ); }, m_index );
+		}
+	}
+
+	const uint64_t QuadTree::AdvanceEpoch()
+	{
+		if( m_trace_recorder != nullptr )
+		{
+			m_trace_recorder->RecordAdvanceEpoch();
+		}
+
+		return ++m_epoch;
+	}
+
+	void QuadTree::ReleaseShape( const Internal::ShapeProvider::Handle handle, Shape* shape )
+	{
+		if( m_trace_recorder != nullptr )
+		{
+			m_trace_recorder->RecordRelease( *shape );
+		}
+
+		NotifySubscriptions( *shape, shape->GetBounds(), std::nullopt );
+		PopShape( *shape );
+		m_shape_provider.Destroy( handle );
+	}
+
+	void QuadTree::UpdateShape( const Shape& shape, const BoundingRect& previous_bounds )
+	{
+		if( m_trace_recorder != nullptr )
+		{
+			m_trace_recorder->RecordMove( shape );
+		}
+
+		NotifySubscriptions( shape, previous_bounds, shape.GetBounds() );
+
+		if( !m_bounds.ConsistsOf( shape.GetBounds() ) )
+		{
+			m_bounds.Grow( shape.GetBounds() );
+			std::visit( []( auto& index ) { index.Reset(); }, m_index );
+			return;
+		}
+
+		std::visit( [&shape, &previous_bounds]( auto& index ) { index.Move( shape, previous_bounds ); }, m_index );
+	}
+
+	void QuadTree::UpdateCategories( const Shape& shape )
+	{
+		if( m_trace_recorder != nullptr )
+		{
+			m_trace_recorder->RecordCategorize( shape );
+		}
+
+		// Bounds of shape stay the same, so the subscriptions are not affected and the shape is re-indexed in place.
+		std::visit( [&shape]( auto& index ) { index.Move( shape, shape.GetBounds() ); }, m_index );
+	}
+
+	QuadTree::QueryResult QuadTree::FindInCircle( const Vector2f& center, const float radius ) const
+	{
+		QueryResult result{ VisitBuiltIndex( [&center, radius]( auto& index ) { return index.Find( BoundingRect{ center }.Resize( radius ) ); } ) };
 
 		auto new_result_end = std::remove_if(
 			result.begin(),
 			result.end(),
 			[&center, radius]( const Shape* shape ) -> const bool
 			{
-				return shape->GetBounds().IsIntersects( center, radius );
+				return !shape->GetBounds().IsIntersects( center, radius );
 			}
 		);
 
@@ -52,10 +372,113 @@ inline namespace Spatial
 		return result;
 	}
 
-	void QuadTree::ReleaseShape( const Internal::ShapeProvider::Handle handle, Shape* shape )
+	QuadTree::SharedShape QuadTree::AddSubscription( Subscription& subscription )
 	{
-		m_tree.Pop( *shape );
-		m_shape_provider.Destroy( handle );
+		if( !m_watchers )
+		{
+			m_watchers = std::make_unique<QuadTree>();
+		}
+
+		SharedShape watcher{ m_watchers->Acquire( subscription.GetBounds() ) };
+		watcher->SetTag( m_subscriptions.size() );
+		m_subscriptions.push_back( &subscription );
+
+		return watcher;
+	}
+
+	void QuadTree::RemoveSubscription( Subscription& subscription )
+	{
+		// The last subscription takes the place of removed one.
+		const size_t index = subscription.m_watcher->GetTag();
+		m_subscriptions[ index ] = m_subscriptions.back();
+		m_subscriptions[ index ]->m_watcher->SetTag( index );
+		m_subscriptions.pop_back();
+	}
+
+	void QuadTree::PushShape( const Shape& shape )
+	{
+		auto push_shape = [this, &shape]()
+		{
+			if( !m_bounds.ConsistsOf( shape.GetBounds() ) )
+			{
+				m_bounds.Grow( shape.GetBounds() );
+				std::visit( []( auto& index ) { index.Reset(); }, m_index );
+			}
+
+			std::visit( [&shape]( auto& index ) { index.Push( shape ); }, m_index );
+		};
+
+		if( !m_is_concurrent_updates )
+		{
+			push_shape();
+			return;
+		}
+
+		// The tree is updated with no lock of quad tree. Bounds do not change concurrently, so the shapes out of them are staged.
+		if( GetIndexKind() == IndexKind::Tree )
+		{
+			if( m_bounds.ConsistsOf( shape.GetBounds() ) )
+			{
+				std::get<Internal::IndexTree>( m_index ).Push( shape );
+				return;
+			}
+
+			std::lock_guard<std::mutex> lock{ m_update_mutex };
+			m_staged_shapes.push_back( &shape );
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock{ m_update_mutex };
+		push_shape();
+	}
+
+	void QuadTree::PopShape( const Shape& shape )
+	{
+		if( !m_is_concurrent_updates )
+		{
+			std::visit( [&shape]( auto& index ) { index.Pop( shape ); }, m_index );
+			return;
+		}
+
+		// Shapes do not move concurrently, so the shape out of indexing bounds is one of the staged shapes.
+		if( GetIndexKind() == IndexKind::Tree )
+		{
+			if( m_bounds.ConsistsOf( shape.GetBounds() ) )
+			{
+				std::get<Internal::IndexTree>( m_index ).Pop( shape );
+				return;
+			}
+
+			std::lock_guard<std::mutex> lock{ m_update_mutex };
+			*std::find( m_staged_shapes.begin(), m_staged_shapes.end(), &shape ) = m_staged_shapes.back();
+			m_staged_shapes.pop_back();
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock{ m_update_mutex };
+		std::visit( [&shape]( auto& index ) { index.Pop( shape ); }, m_index );
+	}
+
+	void QuadTree::NotifySubscriptions( const Shape& shape, const std::optional<BoundingRect>& previous_bounds, const std::optional<BoundingRect>& current_bounds )
+	{
+		if( m_subscriptions.empty() )
+		{
+			return;
+		}
+
+		BoundingRect area{ previous_bounds.value_or( *current_bounds ) };
+		area.Grow( current_bounds.value_or( *previous_bounds ) );
+		for( const auto watcher : m_watchers->Find( area ) )
+		{
+			Subscription& subscription = *m_subscriptions[ watcher->GetTag() ];
+
+			const bool was_inside	= previous_bounds.has_value() && subscription.GetBounds().IsIntersects( *previous_bounds );
+			const bool is_inside	= current_bounds.has_value() && subscription.GetBounds().IsIntersects( *current_bounds );
+			if( was_inside != is_inside )
+			{
+				subscription.m_events.push_back( { &shape, is_inside? Subscription::EventKind::Enter : Subscription::EventKind::Leave } );
+			}
+		}
 	}
 }
 }
@@ -15,7 +15,14 @@ inline namespace Spatial
 		This quad tree automatically manage the bounds of indexing, the spatial index consistency, it tracks the position of acquired shapes.
 		Each shape is represented by bounding rect (AABR) for optimal storing and fast indexation.
 
+		The spatial index itself is selected at construction. By default the shapes are indexed by the quad tree (`IndexKind::Tree`),
+		but densely and uniformly populated spaces may be indexed by the uniform grid (`IndexKind::Grid`) instead.
+
 		This implementation carries no thread safety. So it should be guarded externally to allow the thread-safe usage.
+		The index is built and refined lazily by searching, so even the const searching changes the index and needs the exclusive access.
+		Searching by several threads under the shared lock is allowed only after `Optimize`, which refines the whole index,
+		until the next growing of indexing bounds, and only while no trace recorder is installed.
+		The only exception is the concurrent acquiring and releasing of shapes, which is enabled by `SetConcurrentUpdates`.
 	*/
 	class QuadTree final
 	{
@@ -24,6 +31,9 @@ inline namespace Spatial
 		// Allow the shape to use private interface.
 		friend class Internal::Shape;
 
+		// Allow the subscription to use private interface.
+		friend class Subscription;
+
 
 		// Shape to be indexed.
 		using Shape = Internal::Shape;
@@ -31,35 +41,216 @@ inline namespace Spatial
 		// Shared pointer to shape.
 		using SharedShape = std::shared_ptr<Shape>;
 
+		// Collection of found shapes. Memory of collection is provided by the query arena installed with `QueryArenaScope`.
+		using QueryResult = Internal::QueryResult;
+
+		// Cell of histogram, which aggregates the count and the area of shapes.
+		using HistogramCell = Internal::HistogramCell;
+
+		// Dense grid of histogram cells, stored row by row. Memory of collection is provided just like for `QueryResult`.
+		using HistogramResult = Internal::HistogramResult;
+
+		// Shape hit by sweeping, along with the time of impact.
+		using SweepHit = Internal::SweepHit;
+
+		// Collection of shapes hit by sweeping. Memory of collection is provided just like for `QueryResult`.
+		using SweepResult = Internal::SweepResult;
+
+		// Function to be called for each pair of intersecting shapes, found by the joining of quad trees.
+		using JoinCallback = Internal::JoinCallback;
+
+		// Shared pointer to subscription.
+		using SharedSubscription = std::shared_ptr<Subscription>;
+
+
+		// Kind of spatial index used by quad tree.
+		enum class IndexKind : uint8_t
+		{
+			Tree,	// Shapes are indexed by the tree of quads. Suitable for any distribution of shapes.
+			Grid,	// Shapes are indexed by the uniform grid. Suitable for dense and uniform distribution of shapes.
+		};
+
+	// Lifetime management.
+	public:
+		explicit QuadTree( const IndexKind index_kind = IndexKind::Tree );
+
+		// Create the quad tree, which indexing bounds start from the given ones instead of the origin point.
+		explicit QuadTree( const BoundingRect& bounds, const IndexKind index_kind = IndexKind::Tree );
+
+	// Public static interface.
+	public:
+		// Report each pair of intersecting shapes from the `left` and `right` quad trees. Shapes of `left` tree are passed to the left.
+		// Quad trees may have different bounds of indexing. Indexes of `IndexKind::Tree` are joined by simultaneous descending of both trees.
+		// If `threads_count` is greater than one, the joining is split between threads and the callback is called concurrently.
+		// Other kinds of index are joined by searching the `left` tree for each shape of `right` one, with no threads.
+		static void Join( const QuadTree& left, const QuadTree& right, const JoinCallback& callback, const size_t threads_count = 1 );
+
 	// Public interface.
 	public:
 		// Acquire the shape. Initial bounds should be provided.
 		SharedShape Acquire( const BoundingRect& bounds );
 
+		// Subscribe to the shapes, which enter or leave the given bounds. Shapes intersecting the bounds are reported as entered at once.
+		SharedSubscription Subscribe( const BoundingRect& bounds );
+
 
 		// Perform the spatial searching of shapes in given bounds.
-		std::vector<const Shape*> Find( const BoundingRect& bounds ) const;
+		QueryResult Find( const BoundingRect& bounds ) const;
 
 		// Perform the spatial searching of shapes in given area.
-		std::vector<const Shape*> Find( const Vector2f& center, const float radius ) const;
+		QueryResult Find( const Vector2f& center, const float radius ) const;
+
+		// Perform the spatial searching of shapes in given bounds. Searching starts from the place remembered by hint at previous searching.
+		// Hint is used only by `IndexKind::Tree`.
+		QueryResult Find( const BoundingRect& bounds, QueryHint& hint ) const;
+
+		// Perform the spatial searching of shapes in given bounds, which belong to any of given categories.
+		// Parts of index with no shapes of given categories are skipped. Searching with `Shape::ALL_CATEGORIES` finds all the shapes.
+		QueryResult Find( const BoundingRect& bounds, const uint64_t categories ) const;
+
+		// Perform the spatial searching of shapes in given bounds, which were acquired or changed at given epoch or later.
+		// Parts of index with no such shapes are skipped. Released shapes are not tracked.
+		QueryResult FindChangedSince( const BoundingRect& bounds, const uint64_t epoch ) const;
+
+		// Perform the spatial searching of shapes in given convex polygon.
+		QueryResult Find( const ConvexPolygon& polygon ) const;
+
+		// Perform the spatial searching of shapes in given oriented rect.
+		QueryResult Find( const OrientedRect& rect ) const;
+
+		// Perform the spatial searching of shapes in given bounds. Result is ordered as described by options.
+		QueryResult Find( const BoundingRect& bounds, const QueryOptions& options ) const;
+
+		// Perform the spatial searching of shapes in given area. Result is ordered as described by options.
+		QueryResult Find( const Vector2f& center, const float radius, const QueryOptions& options ) const;
+
+
+		// Perform the searching of shapes hit by the bounds, moving along the displacement. Result is ordered by the time of impact.
+		// Only the earliest hit is searched if `is_first_hit_only` is set.
+		SweepResult FindSwept( const BoundingRect& bounds, const Vector2f& displacement, const bool is_first_hit_only = false ) const;
+
+
+		// Whether any shape lies in given bounds. Searching stops at first found shape.
+		const bool Any( const BoundingRect& bounds ) const;
+
+		// Count the shapes in given bounds with no enumeration of them.
+		const size_t Count( const BoundingRect& bounds ) const;
+
+		// Aggregate the count and the area of shapes by cells of the `columns` x `rows` grid over given bounds.
+		// Each shape is accounted by the cell, which contains the center of shape, along with the whole area of shape bounds.
+		// Index of `IndexKind::Tree` accounts its subtrees inside single cell with no enumeration of shapes.
+		// Shapes with no extent, which centers lie exactly on the border of cells, may be accounted by either adjacent cell.
+		HistogramResult Histogram( const BoundingRect& bounds, const size_t columns, const size_t rows ) const;
+
+
+		// Perform the searching of up to `count` largest shapes in given bounds, measured by the key. Result is ordered by descending size.
+		// Index of `IndexKind::Tree` visits the shallow quads with the largest shapes first and stops once no larger shape may be found.
+		QueryResult FindTop( const BoundingRect& bounds, const size_t count, const SizeKey key ) const;
+
+		// Perform the searching of up to `count` largest shapes in given bounds, visiting at most `visits_budget` nodes of index.
+		// Nodes are quads for `IndexKind::Tree` and cells for `IndexKind::Grid`. Once the budget is spent, the largest of visited shapes are given.
+		QueryResult FindTop( const BoundingRect& bounds, const size_t count, const SizeKey key, const size_t visits_budget ) const;
+
+
+		// Lay out the index in memory in order of searching. It is useful after bulk insertion or periodically at idle time.
+		// The optimization is supported only by `IndexKind::Tree`. The index is built and completely refined, if it was not,
+		// so the following searching does not change it until the indexing bounds grow.
+		void Optimize();
+
+		// Enable or disable the acquiring and releasing of shapes by several threads at once. It should be switched at the point of synchronization.
+		// While enabled, no other operation should be performed, including the moving of shapes, subscriptions and trace recording.
+		// Index of `IndexKind::Tree` updates the disjoint subtrees in parallel, other kinds of index serialize the updates.
+		// Indexing bounds of `IndexKind::Tree` do not grow concurrently. Shapes out of them are staged under the lock and indexed
+		// once the concurrent updates are disabled, so the bounds should be set up by the first shapes, if possible.
+		void SetConcurrentUpdates( const bool is_enabled );
+
+		// Whether the shapes may be acquired and released by several threads at once.
+		inline const bool IsConcurrentUpdates() const	{ return m_is_concurrent_updates; };
+
+
+		// Start the next epoch of changes. Shapes acquired or changed after this call are marked by the new epoch. Returns the new epoch.
+		const uint64_t AdvanceEpoch();
+
+		// Get the current epoch of changes.
+		inline const uint64_t GetEpoch() const			{ return m_epoch; };
+
+
+		// Install the recorder of workload trace. Recording is disabled by `nullptr`, which is the default.
+		inline void SetTraceRecorder( TraceRecorder* recorder )		{ m_trace_recorder = recorder; };
+
+		// Get the installed recorder of workload trace.
+		inline TraceRecorder* GetTraceRecorder() const				{ return m_trace_recorder; };
 
 
 		// Get the bounds of indexing.
 		inline const BoundingRect& GetBounds() const	{ return m_bounds; };
 
+		// Get the kind of spatial index.
+		inline const IndexKind GetIndexKind() const		{ return IndexKind( m_index.index() ); };
+
+	// Private inner types.
+	private:
+		// Spatial index. Order of alternatives corresponds to `IndexKind`.
+		using Index = std::variant<Internal::IndexTree, Internal::GridIndex>;
+
 	// Private interface.
 	private:
 		// Perform the shape releasing.
 		void ReleaseShape( const Internal::ShapeProvider::Handle handle, Shape* shape );
 
+		// Perform the re-indexation of shape, that was moved from `previous_bounds`.
+		void UpdateShape( const Shape& shape, const BoundingRect& previous_bounds );
+
+		// Perform the re-indexation of shape, which categories were changed.
+		void UpdateCategories( const Shape& shape );
+
+		// Perform the spatial searching of shapes in given circle with no recording of trace.
+		QueryResult FindInCircle( const Vector2f& center, const float radius ) const;
+
+
+		// Push the acquired shape to the index, growing the indexing bounds if needed. Concurrent pushing takes no lock of quad tree,
+		// unless the shape is staged out of indexing bounds or the index is not `IndexKind::Tree`.
+		void PushShape( const Shape& shape );
+
+		// Pop the released shape from the index or from the staged shapes. Concurrent popping takes the lock just like the pushing.
+		void PopShape( const Shape& shape );
+
+
+		// Register the subscription. Returns the shape of subscription in the tree of subscriptions.
+		SharedShape AddSubscription( Subscription& subscription );
+
+		// Unregister the subscription.
+		void RemoveSubscription( Subscription& subscription );
+
+		// Report the change of shape bounds to the subscriptions near the shape. Missing bounds mean the shape was acquired or released.
+		void NotifySubscriptions( const Shape& shape, const std::optional<BoundingRect>& previous_bounds, const std::optional<BoundingRect>& current_bounds );
+
+
+		// Invoke the function with spatial index, which is built before the invocation.
+		template< typename TFunction >
+		inline decltype( auto ) VisitBuiltIndex( TFunction&& function ) const;
+
+		// Record the searching to the installed trace recorder. The event is filled by the function only when the recorder is installed.
+		template< typename TFunction >
+		inline void RecordFind( TFunction&& fill_event ) const;
+
 	// Private state.
 	private:
 		Internal::ShapeProvider	m_shape_provider;			// Provider for shapes.
 		BoundingRect			m_bounds{ { 0.0f, 0.0f } };	// The indexing area.
+		uint64_t				m_epoch = 0;				// Current epoch of changes.
+		TraceRecorder*			m_trace_recorder = nullptr;	// Recorder of workload trace, if installed.
+
+		std::mutex				m_update_mutex;						// Guard for the staged shapes and for the concurrent updates of non-tree index.
+		Internal::Shapes		m_staged_shapes;					// Shapes acquired concurrently out of indexing bounds, which are not indexed yet.
+		bool					m_is_concurrent_updates = false;	// Whether the shapes may be acquired and released concurrently.
+
+		std::vector<Subscription*>	m_subscriptions;	// Subscriptions, stored by the tags of their shapes in the tree of subscriptions.
+		std::unique_ptr<QuadTree>	m_watchers;			// Tree of subscriptions. It is created by the first subscription.
 
 	// Private non-state.
 	private:
-		mutable Internal::IndexTree	m_tree; // The quad tree.
+		mutable Index	m_index; // The spatial index.
 	};
 }
 }
@@ -0,0 +1,38 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+	template< typename TFunction >
+	inline decltype( auto ) QuadTree::VisitBuiltIndex( TFunction&& function ) const
+	{
+		return std::visit(
+			[this, &function]( auto& index ) -> decltype( auto )
+			{
+				if( index.IsEmpty() )
+				{
+					index.Build( m_bounds );
+				}
+
+				return function( index );
+			},
+			m_index
+		);
+	}
+
+	template< typename TFunction >
+	inline void QuadTree::RecordFind( TFunction&& fill_event ) const
+	{
+		if( m_trace_recorder == nullptr )
+		{
+			return;
+		}
+
+		TraceRecorder::Event event;
+		fill_event( event );
+		m_trace_recorder->RecordFind( event );
+	}
+}
+}
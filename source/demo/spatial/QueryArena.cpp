@@ -0,0 +1,29 @@
+#include <demo/spatial/spatial.h>
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+	QueryArena::QueryArena( const size_t capacity )
+		: m_buffer{ std::make_unique<std::byte[]>( capacity ) }
+		, m_resource{ m_buffer.get(), capacity }
+	{
+	}
+
+	void QueryArena::Reset()
+	{
+		m_resource.release();
+	}
+
+	QueryArenaScope::QueryArenaScope( QueryArena& arena )
+		: m_previous_resource{ Internal::ExchangeQueryResource( arena.GetResource() ) }
+	{
+	}
+
+	QueryArenaScope::~QueryArenaScope()
+	{
+		Internal::ExchangeQueryResource( m_previous_resource );
+	}
+}
+}
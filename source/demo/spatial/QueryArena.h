@@ -0,0 +1,72 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+	/**
+		@brief	Memory arena for the spatial searching.
+
+		Arena is a monotonic (bump) allocator with preallocated buffer. All the memory, given by arena, is released at once by `Reset`.
+		After the reset the preallocated buffer is reused again, so the whole tick worth of queries may be performed with no heap allocations.
+		Arena is installed for the current thread by `QueryArenaScope`. Arena should not be used by several threads simultaneously.
+
+		The results of spatial searching, performed while the arena is installed, are allocated by arena.
+		Such results should not be used after the arena is reset.
+	*/
+	class QueryArena final
+	{
+	// Public constants.
+	public:
+		// Default size of preallocated buffer, in bytes.
+		static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;
+
+	// Lifetime management.
+	public:
+		explicit QueryArena( const size_t capacity = DEFAULT_CAPACITY );
+		QueryArena( const QueryArena& ) = delete;
+		inline ~QueryArena() noexcept = default;
+
+
+		QueryArena& operator = ( const QueryArena& ) = delete;
+
+	// Public interface.
+	public:
+		// Release all the memory given by arena.
+		void Reset();
+
+
+		// Get the memory resource of arena.
+		inline std::pmr::memory_resource* GetResource()		{ return &m_resource; };
+
+	// Private state.
+	private:
+		std::unique_ptr<std::byte[]>		m_buffer;	// Preallocated buffer.
+		std::pmr::monotonic_buffer_resource	m_resource;	// Memory resource over the preallocated buffer.
+	};
+
+
+	/**
+		@brief	Scope guard to install the query arena.
+
+		While the guard lives, the given arena is used by the spatial searching on the current thread.
+		Once the guard is destroyed, the previously installed arena (if any) is restored.
+	*/
+	class QueryArenaScope final
+	{
+	// Lifetime management.
+	public:
+		explicit QueryArenaScope( QueryArena& arena );
+		QueryArenaScope( const QueryArenaScope& ) = delete;
+		~QueryArenaScope();
+
+
+		QueryArenaScope& operator = ( const QueryArenaScope& ) = delete;
+
+	// Private state.
+	private:
+		std::pmr::memory_resource*	m_previous_resource; // Resource installed before the scope.
+	};
+}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+	/**
+		@brief	Hint for temporally coherent spatial searching.
+
+		Hint remembers the deepest quad of index tree, which enclosed the last searched bounds with no shared edge. The next searching with same hint starts from
+		that quad and climbs up only if the new bounds escape it. So the repeated searching of almost the same bounds skips the top of tree.
+		Hint should be kept by consumer between the searches. Hint does not prolong the lifetime of quads, it just expires once its quad is released.
+		Hint is harmless for any other tree or kind of index, it is just not used there.
+	*/
+	class QueryHint final
+	{
+	// Friendship declarations.
+	public:
+		// Allow the index tree to use private state.
+		friend class Internal::IndexTree;
+
+	// Public interface.
+	public:
+		// Forget the remembered quad.
+		inline void Reset()	{ m_quad.reset(); };
+
+	// Private state.
+	private:
+		std::weak_ptr<Internal::Quad>	m_quad;				// The remembered quad.
+		const Internal::IndexTree*		m_tree = nullptr;	// The tree, which the remembered quad belongs to.
+	};
+}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+	// Order of shapes in the result of spatial searching.
+	enum class ResultOrder : uint8_t
+	{
+		None,		// Shapes are given in order of index traversal.
+		ByTag,		// Shapes are ordered by ascending tag.
+		ByDistance,	// Shapes are ordered by ascending distance from `QueryOptions::origin` to shape bounds.
+		ByMemory,	// Shapes are ordered by their placement in memory. Best suited for the following sequential processing.
+	};
+
+	// Key to measure the size of shapes, used by the searching of the largest shapes.
+	enum class SizeKey : uint8_t
+	{
+		Area,	// Size is the area of shape bounds.
+		Extent,	// Size is the longest side of shape bounds.
+	};
+
+
+	/**
+		@brief	Options of spatial searching.
+
+		Options describe the post-processing of found shapes. By default the result is given as-is, with no ordering.
+	*/
+	struct QueryOptions final
+	{
+		ResultOrder	order		= ResultOrder::None;	// Order of shapes in result.
+		Vector2f	origin{ 0.0f, 0.0f };				// Point to measure the distance from, used only for `ResultOrder::ByDistance`.
+		bool		deduplicate	= false;				// Whether the repeated shapes should be removed from result.
+	};
+}
+}
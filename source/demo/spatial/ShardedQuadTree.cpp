@@ -0,0 +1,184 @@
+#include <demo/spatial/spatial.h>
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+namespace
+{
+	// Fraction of shard size, which widens the reach of shard.
+	constexpr float REACH_MARGIN = 0.001f;
+}
+
+
+	ShardedQuadTree::ShardedShape::ShardedShape( ShardedQuadTree& host, QuadTree::SharedShape shape, const size_t shard_index )
+		: m_host{ host }
+		, m_shape{ std::move( shape ) }
+		, m_shard_index{ shard_index }
+	{
+	}
+
+	void ShardedQuadTree::ShardedShape::SetBounds( const BoundingRect& bounds )
+	{
+		m_shape->SetBounds( bounds );
+		m_host.TrackShape( *this );
+	}
+
+	ShardedQuadTree::ShardedQuadTree( const BoundingRect& bounds, const size_t columns, const size_t rows, const IndexKind index_kind )
+		: m_bounds{ bounds }
+		, m_columns{ std::max<size_t>( columns, 1 ) }
+		, m_rows{ std::max<size_t>( rows, 1 ) }
+	{
+		const Vector2f size{ bounds.GetSize() };
+		m_shard_scale = { Internal::GetGridScale( size.x, m_columns ), Internal::GetGridScale( size.y, m_rows ) };
+
+		// Reach of shard is widened by the small margin, so the rounding of shard coordinates never leaves the center outside of it.
+		constexpr float INFINITE_OFFSET = std::numeric_limits<float>::infinity();
+		const Vector2f shard_size{ size.x / float( m_columns ), size.y / float( m_rows ) };
+		const Vector2f margin{ shard_size * REACH_MARGIN };
+
+		m_shards.reserve( m_columns * m_rows );
+		for( size_t row = 0; row < m_rows; ++row )
+		{
+			for( size_t column = 0; column < m_columns; ++column )
+			{
+				const Vector2f region_min{ bounds.min.x + shard_size.x * float( column ), bounds.min.y + shard_size.y * float( row ) };
+				const BoundingRect region{ region_min, region_min + shard_size, std::ignore };
+
+				BoundingRect reach{ region.min - margin, region.max + margin, std::ignore };
+				reach.min.x = ( column == 0 )? -INFINITE_OFFSET : reach.min.x;
+				reach.min.y = ( row == 0 )? -INFINITE_OFFSET : reach.min.y;
+				reach.max.x = ( column + 1 == m_columns )? INFINITE_OFFSET : reach.max.x;
+				reach.max.y = ( row + 1 == m_rows )? INFINITE_OFFSET : reach.max.y;
+
+				m_shards.push_back( std::make_unique<Shard>( region, reach, index_kind ) );
+			}
+		}
+	}
+
+	ShardedQuadTree::SharedShape ShardedQuadTree::Acquire( const BoundingRect& bounds )
+	{
+		const size_t shard_index = GetShardIndex( bounds.GetCenter() );
+
+		Shard& shard = *m_shards[ shard_index ];
+		shard.max_shape_size.Maximize( bounds.GetSize() );
+		return std::make_shared<ShardedShape>( *this, shard.tree.Acquire( bounds ), shard_index );
+	}
+
+	void ShardedQuadTree::Migrate()
+	{
+		for( auto& shard : m_shards )
+		{
+			// Scheduled shapes either move to other shards or stay in the region of this one.
+			shard->migrating_extent = Internal::EMPTY_EXTENT;
+			for( const auto& migrating_shape : std::exchange( shard->migrating_shapes, {} ) )
+			{
+				// The shape may be released or moved back to its region since the scheduling.
+				const SharedShape shape{ migrating_shape.lock() };
+				if( !shape )
+				{
+					continue;
+				}
+
+				shape->m_is_migrating = false;
+
+				const size_t shard_index = GetShardIndex( shape->GetBounds().GetCenter() );
+				if( shard_index == shape->m_shard_index )
+				{
+					continue;
+				}
+
+				Shard& target_shard = *m_shards[ shard_index ];
+				target_shard.max_shape_size.Maximize( shape->GetBounds().GetSize() );
+
+				QuadTree::SharedShape migrated_shape{ target_shard.tree.Acquire( shape->GetBounds() ) };
+				migrated_shape->SetTag( shape->GetTag() );
+
+				shape->m_shape			= std::move( migrated_shape );
+				shape->m_shard_index	= shard_index;
+			}
+		}
+	}
+
+	ShardedQuadTree::QueryResult ShardedQuadTree::Find( const BoundingRect& bounds ) const
+	{
+		QueryResult result{ Internal::GetQueryResource() };
+		VisitShards(
+			bounds,
+			[&result, &bounds]( const QuadTree& tree )
+			{
+				const QueryResult shard_result{ tree.Find( bounds ) };
+				result.insert( result.end(), shard_result.begin(), shard_result.end() );
+			}
+		);
+
+		return result;
+	}
+
+	ShardedQuadTree::QueryResult ShardedQuadTree::Find( const Vector2f& center, const float radius ) const
+	{
+		QueryResult result{ Internal::GetQueryResource() };
+		VisitShards(
+			BoundingRect{ center }.Resize( radius ),
+			[&result, &center, radius]( const QuadTree& tree )
+			{
+				const QueryResult shard_result{ tree.Find( center, radius ) };
+				result.insert( result.end(), shard_result.begin(), shard_result.end() );
+			}
+		);
+
+		return result;
+	}
+
+	const size_t ShardedQuadTree::Count( const BoundingRect& bounds ) const
+	{
+		size_t result = 0;
+		VisitShards( bounds, [&result, &bounds]( const QuadTree& tree ) { result += tree.Count( bounds ); } );
+
+		return result;
+	}
+
+	const size_t ShardedQuadTree::GetShardIndex( const Vector2f& point ) const
+	{
+		const Vector2f offset{ point - m_bounds.min };
+		const size_t column	= Internal::GetGridCoordinate( offset.x, m_shard_scale.x, m_columns );
+		const size_t row	= Internal::GetGridCoordinate( offset.y, m_shard_scale.y, m_rows );
+
+		return row * m_columns + column;
+	}
+
+	void ShardedQuadTree::TrackShape( ShardedShape& shape )
+	{
+		Shard& shard = *m_shards[ shape.m_shard_index ];
+		shard.max_shape_size.Maximize( shape.GetBounds().GetSize() );
+		if( GetShardIndex( shape.GetBounds().GetCenter() ) == shape.m_shard_index )
+		{
+			return;
+		}
+
+		// The shape may move several times before the migration, so each of its bounds is gathered.
+		shard.migrating_extent.Grow( shape.GetBounds() );
+		if( !shape.m_is_migrating )
+		{
+			shape.m_is_migrating = true;
+			shard.migrating_shapes.push_back( shape.weak_from_this() );
+		}
+	}
+
+	template< typename TVisitor >
+	void ShardedQuadTree::VisitShards( const BoundingRect& bounds, TVisitor&& visitor ) const
+	{
+		// Shapes, which centers lie in the reach of shard, overhang it at most by the half of the largest shape size.
+		for( const auto& shard : m_shards )
+		{
+			const Vector2f overhang{ shard->max_shape_size * 0.5f };
+			const BoundingRect resident_extent{ shard->reach.min - overhang, shard->reach.max + overhang, std::ignore };
+			if( bounds.IsIntersects( resident_extent ) || bounds.IsIntersects( shard->migrating_extent ) )
+			{
+				visitor( shard->tree );
+			}
+		}
+	}
+}
+}
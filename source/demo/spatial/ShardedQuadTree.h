@@ -0,0 +1,159 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+	/**
+		@brief	Quad tree, sharded by regions of space.
+
+		Sharded tree splits the given bounds into the grid of regions. Each region is indexed by independently owned `QuadTree` shard.
+		Shape is owned by the shard, which region contains the center of shape bounds. Shards may be updated by different threads,
+		as long as each thread acquires and moves only the shapes of its own shards.
+
+		Once the shape moves out of its region, it still stays in the same shard and only becomes scheduled for migration.
+		Scheduled shapes are moved to their new shards by `Migrate`, which should be called at the point of synchronization between threads.
+		Searching visits each shard, which may hold the shapes intersecting the searched area, and merges the results.
+		Shapes of shard overhang its region at most by the half of the largest shape size, seen by the shard. Only the shapes scheduled
+		for migration may lie farther, so their bounds are gathered by the shard until the next migration.
+		Since each shape is owned by only one shard, the merged result has no repeated shapes.
+
+		Shapes of different shards are different instances of `QuadTree::Shape`. So the shape instance is changed by migration,
+		but the tag of shape is kept. The searching should not be performed simultaneously with the updating of shards.
+	*/
+	class ShardedQuadTree final
+	{
+	// Public inner types.
+	public:
+		// Shape of quad tree shard.
+		using Shape = QuadTree::Shape;
+
+		// Collection of found shapes.
+		using QueryResult = QuadTree::QueryResult;
+
+		// Kind of spatial index used by shards.
+		using IndexKind = QuadTree::IndexKind;
+
+
+		/**
+			@brief	Shape of sharded tree.
+
+			Sharded shape owns the shape of its current shard and tracks the migration between shards.
+		*/
+		class ShardedShape final : public std::enable_shared_from_this<ShardedShape>
+		{
+		// Friendship declarations.
+		public:
+			// Allow the sharded tree to perform the migration.
+			friend class ShardedQuadTree;
+
+		// Lifetime management.
+		public:
+			ShardedShape( ShardedQuadTree& host, QuadTree::SharedShape shape, const size_t shard_index );
+
+		// Public interface.
+		public:
+			// Set new bounds of shape. Shape is scheduled for migration if its center leaves the region of shard.
+			void SetBounds( const BoundingRect& bounds );
+
+			// Set the abstract tag for shape. Tag is kept through the migration.
+			inline void SetTag( const size_t value )					{ m_shape->SetTag( value ); };
+
+
+			// Get current bounds of shape.
+			inline const BoundingRect& GetBounds() const				{ return m_shape->GetBounds(); };
+
+			// Get the abstract tag of shape.
+			inline const size_t GetTag() const							{ return m_shape->GetTag(); };
+
+			// Get the shape instance in current shard.
+			inline const Shape& GetShape() const						{ return *m_shape; };
+
+			// Get the index of shard, which owns the shape.
+			inline const size_t GetShardIndex() const					{ return m_shard_index; };
+
+		// Private state.
+		private:
+			ShardedQuadTree&		m_host;					// Sharded tree that host shape.
+			QuadTree::SharedShape	m_shape;				// Shape instance in current shard.
+			size_t					m_shard_index;			// Index of shard, which owns the shape.
+			bool					m_is_migrating = false;	// Whether the shape is scheduled for migration.
+		};
+
+
+		// Shared pointer to sharded shape.
+		using SharedShape = std::shared_ptr<ShardedShape>;
+
+	// Lifetime management.
+	public:
+		ShardedQuadTree( const BoundingRect& bounds, const size_t columns, const size_t rows, const IndexKind index_kind = IndexKind::Tree );
+
+	// Public interface.
+	public:
+		// Acquire the shape. The shape is owned by the shard, which region contains the center of bounds.
+		SharedShape Acquire( const BoundingRect& bounds );
+
+		// Move the shapes, scheduled for migration, to the shards of their current regions.
+		void Migrate();
+
+
+		// Perform the spatial searching of shapes in given bounds.
+		QueryResult Find( const BoundingRect& bounds ) const;
+
+		// Perform the spatial searching of shapes in given area.
+		QueryResult Find( const Vector2f& center, const float radius ) const;
+
+		// Count the shapes in given bounds with no enumeration of them.
+		const size_t Count( const BoundingRect& bounds ) const;
+
+
+		// Get the index of shard, which region contains the given point. Points outside the sharded bounds belong to the border shards.
+		const size_t GetShardIndex( const Vector2f& point ) const;
+
+		// Get the shard by index.
+		inline const QuadTree& GetShard( const size_t index ) const	{ return m_shards[ index ]->tree; };
+
+		// Get the count of shards.
+		inline const size_t GetShardsCount() const						{ return m_shards.size(); };
+
+		// Get the sharded bounds.
+		inline const BoundingRect& GetBounds() const					{ return m_bounds; };
+
+	// Private inner types.
+	private:
+		// Shard of tree.
+		struct Shard final
+		{
+			Shard( const BoundingRect& region, const BoundingRect& reach, const IndexKind index_kind )
+				: tree{ region, index_kind }
+				, reach{ reach }
+			{};
+
+
+			QuadTree									tree;											// Tree, which indexes the shapes of shard.
+			BoundingRect								reach;											// Area of centers of shard shapes. Border shards reach the infinity.
+			Vector2f									max_shape_size{ 0.0f, 0.0f };					// Per-axis maximum of sizes of shapes ever owned by shard.
+			BoundingRect								migrating_extent{ Internal::EMPTY_EXTENT };		// Bounds of shapes scheduled for migration.
+			std::vector<std::weak_ptr<ShardedShape>>	migrating_shapes;								// Shapes of shard, scheduled for migration.
+		};
+
+	// Private interface.
+	private:
+		// Account the current bounds of shape by its shard. The shape is scheduled for migration if its center leaves the region of shard.
+		void TrackShape( ShardedShape& shape );
+
+		// Visit each shard, which may hold the shapes intersecting the given bounds.
+		template< typename TVisitor >
+		void VisitShards( const BoundingRect& bounds, TVisitor&& visitor ) const;
+
+	// Private state.
+	private:
+		std::vector<std::unique_ptr<Shard>>	m_shards;		// Shards, stored row by row.
+		BoundingRect						m_bounds;		// Sharded bounds.
+		size_t								m_columns;		// Count of shard columns.
+		size_t								m_rows;			// Count of shard rows.
+		Vector2f							m_shard_scale;	// Scale to translate the offset from `m_bounds.min` into shard coordinates.
+	};
+}
+}
@@ -0,0 +1,420 @@
+#include <demo/spatial/spatial.h>
+
+#include <fstream>
+#include <string>
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+namespace
+{
+	// Signature of the manifest file.
+	constexpr uint32_t MANIFEST_SIGNATURE = 0x4D545144;
+
+
+	// Write the trivially copyable value to the binary stream.
+	template< typename TValue >
+	void WriteValue( std::ostream& stream, const TValue& value )
+	{
+		stream.write( reinterpret_cast<const char*>( &value ), sizeof( TValue ) );
+	}
+
+	// Read the trivially copyable value from the binary stream. Returns whether the value was read.
+	template< typename TValue >
+	const bool ReadValue( std::istream& stream, TValue& value )
+	{
+		return bool( stream.read( reinterpret_cast<char*>( &value ), sizeof( TValue ) ) );
+	}
+
+
+	// Get the path to the manifest of tiles.
+	std::filesystem::path GetManifestPath( const std::filesystem::path& directory )
+	{
+		return directory / "manifest.bin";
+	}
+
+	// Get the path to the file of tile.
+	std::filesystem::path GetTilePath( const std::filesystem::path& directory, const size_t index )
+	{
+		return directory / ( "tile_" + std::to_string( index ) + ".bin" );
+	}
+
+
+	// Get the estimated memory of resident tile.
+	const size_t GetTileMemory( const size_t shapes_count )
+	{
+		return shapes_count * StreamingQuadTree::SHAPE_MEMORY_ESTIMATE;
+	}
+}
+
+
+	StreamingQuadTree::StreamingQuadTree( const std::filesystem::path& directory, const size_t memory_budget )
+		: m_directory{ directory }
+		, m_memory_budget{ memory_budget }
+	{
+		std::ifstream manifest{ GetManifestPath( directory ), std::ios::binary };
+
+		uint32_t signature = 0;
+		BoundingRect bounds;
+		uint64_t columns	= 0;
+		uint64_t rows		= 0;
+		if( !ReadValue( manifest, signature ) || ( signature != MANIFEST_SIGNATURE )
+			|| !ReadValue( manifest, bounds ) || !ReadValue( manifest, columns ) || !ReadValue( manifest, rows ) )
+		{
+			return;
+		}
+
+		std::vector<Tile> tiles( size_t( columns * rows ) );
+		for( auto& tile : tiles )
+		{
+			uint64_t shapes_count = 0;
+			if( !ReadValue( manifest, tile.content_bounds ) || !ReadValue( manifest, shapes_count ) )
+			{
+				return;
+			}
+
+			tile.shapes_count = size_t( shapes_count );
+		}
+
+		const Vector2f size{ bounds.GetSize() };
+
+		m_tiles			= std::move( tiles );
+		m_bounds		= bounds;
+		m_columns		= size_t( columns );
+		m_rows			= size_t( rows );
+		m_tile_scale	= { Internal::GetGridScale( size.x, m_columns ), Internal::GetGridScale( size.y, m_rows ) };
+
+		m_prefetch_thread = std::thread{ [this]() { RunPrefetching(); } };
+	}
+
+	StreamingQuadTree::~StreamingQuadTree()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ m_prefetch_mutex };
+			m_is_stopping = true;
+		}
+
+		m_prefetch_condition.notify_all();
+		if( m_prefetch_thread.joinable() )
+		{
+			m_prefetch_thread.join();
+		}
+	}
+
+	const bool StreamingQuadTree::WriteTiles(
+		const std::filesystem::path& directory,
+		const BoundingRect& bounds,
+		const size_t columns,
+		const size_t rows,
+		const std::vector<ShapeRecord>& records
+	)
+	{
+		std::error_code error;
+		std::filesystem::create_directories( directory, error );
+		if( error )
+		{
+			return false;
+		}
+
+		const size_t tile_columns	= std::max<size_t>( columns, 1 );
+		const size_t tile_rows		= std::max<size_t>( rows, 1 );
+		const Vector2f size{ bounds.GetSize() };
+		const Vector2f tile_scale{ Internal::GetGridScale( size.x, tile_columns ), Internal::GetGridScale( size.y, tile_rows ) };
+
+		std::vector<std::vector<const ShapeRecord*>> tiles_records( tile_columns * tile_rows );
+		for( const auto& record : records )
+		{
+			const Vector2f offset{ record.bounds.GetCenter() - bounds.min };
+			const size_t column	= Internal::GetGridCoordinate( offset.x, tile_scale.x, tile_columns );
+			const size_t row	= Internal::GetGridCoordinate( offset.y, tile_scale.y, tile_rows );
+
+			tiles_records[ row * tile_columns + column ].push_back( &record );
+		}
+
+		std::ofstream manifest{ GetManifestPath( directory ), std::ios::binary | std::ios::trunc };
+		WriteValue( manifest, MANIFEST_SIGNATURE );
+		WriteValue( manifest, bounds );
+		WriteValue( manifest, uint64_t( tile_columns ) );
+		WriteValue( manifest, uint64_t( tile_rows ) );
+
+		bool is_written = bool( manifest );
+		for( size_t index = 0; index < tiles_records.size(); ++index )
+		{
+			const auto& tile_records = tiles_records[ index ];
+
+			BoundingRect content_bounds;
+			if( !tile_records.empty() )
+			{
+				content_bounds = tile_records.front()->bounds;
+
+				std::ofstream tile{ GetTilePath( directory, index ), std::ios::binary | std::ios::trunc };
+				for( const auto record : tile_records )
+				{
+					content_bounds.Grow( record->bounds );
+
+					WriteValue( tile, record->bounds );
+					WriteValue( tile, uint64_t( record->tag ) );
+					WriteValue( tile, record->categories );
+				}
+
+				is_written &= bool( tile );
+			}
+
+			WriteValue( manifest, content_bounds );
+			WriteValue( manifest, uint64_t( tile_records.size() ) );
+		}
+
+		return is_written && bool( manifest );
+	}
+
+	StreamingQuadTree::QueryResult StreamingQuadTree::Find( const BoundingRect& bounds )
+	{
+		return FindInTiles( bounds, [&bounds]( const QuadTree& tree ) { return tree.Find( bounds ); } );
+	}
+
+	StreamingQuadTree::QueryResult StreamingQuadTree::Find( const Vector2f& center, const float radius )
+	{
+		return FindInTiles( BoundingRect{ center }.Resize( radius ), [&center, radius]( const QuadTree& tree ) { return tree.Find( center, radius ); } );
+	}
+
+	void StreamingQuadTree::ResetPagingStats()
+	{
+		m_stats = { 0, 0, 0, 0, m_stats.resident_tiles, m_stats.resident_memory };
+	}
+
+	template< typename TSearch >
+	StreamingQuadTree::QueryResult StreamingQuadTree::FindInTiles( const BoundingRect& bounds, TSearch&& search )
+	{
+		++m_searches_count;
+		AcceptPrefetchedTiles();
+
+		QueryResult result{ Internal::GetQueryResource() };
+		for( size_t index = 0; index < m_tiles.size(); ++index )
+		{
+			// Shapes may overhang the regions of their tiles, so the bounds of tile content are tested instead of regions.
+			Tile& tile = m_tiles[ index ];
+			if( ( tile.shapes_count == 0 ) || !tile.content_bounds.IsIntersects( bounds ) )
+			{
+				continue;
+			}
+
+			if( tile.content )
+			{
+				++m_stats.hits;
+			}
+			else
+			{
+				PageIn( index );
+			}
+
+			tile.last_use = m_searches_count;
+
+			const QueryResult tile_result{ search( tile.content->tree ) };
+			result.insert( result.end(), tile_result.begin(), tile_result.end() );
+		}
+
+		RequestPrefetch( bounds );
+		EvictTiles();
+		return result;
+	}
+
+	std::unique_ptr<StreamingQuadTree::TileContent> StreamingQuadTree::ReadTile( const size_t index ) const
+	{
+		auto content = std::make_unique<TileContent>();
+
+		std::ifstream file{ GetTilePath( m_directory, index ), std::ios::binary };
+		BoundingRect bounds;
+		uint64_t tag		= 0;
+		uint64_t categories	= 0;
+		while( ReadValue( file, bounds ) && ReadValue( file, tag ) && ReadValue( file, categories ) )
+		{
+			QuadTree::SharedShape shape{ content->tree.Acquire( bounds ) };
+			shape->SetTag( size_t( tag ) );
+			shape->SetCategories( categories );
+
+			content->shapes.push_back( std::move( shape ) );
+		}
+
+		return content;
+	}
+
+	void StreamingQuadTree::PageIn( const size_t index )
+	{
+		std::unique_ptr<TileContent> waited_content;
+		{
+			std::unique_lock<std::mutex> lock{ m_prefetch_mutex };
+
+			// Request, which is not taken by the prefetching thread yet, is cancelled. The tile being read is waited for.
+			auto found_request = std::find( m_requested_tiles.begin(), m_requested_tiles.end(), index );
+			if( found_request != m_requested_tiles.end() )
+			{
+				m_requested_tiles.erase( found_request );
+			}
+			else
+			{
+				m_prefetch_condition.wait( lock, [this, index]() { return !m_is_reading || ( m_reading_tile != index ); } );
+			}
+
+			// Tile, which was waited for, is taken apart so it is not counted as prefetched.
+			auto found_tile = std::find_if(
+				m_prefetched_tiles.begin(),
+				m_prefetched_tiles.end(),
+				[index]( const PrefetchedTile& prefetched_tile ) { return prefetched_tile.index == index; }
+			);
+			if( found_tile != m_prefetched_tiles.end() )
+			{
+				waited_content = std::move( found_tile->content );
+				m_prefetched_tiles.erase( found_tile );
+			}
+		}
+
+		m_tiles[ index ].is_requested = false;
+		AcceptPrefetchedTiles();
+
+		Tile& tile = m_tiles[ index ];
+		if( tile.content )
+		{
+			return;
+		}
+
+		if( waited_content )
+		{
+			SetContent( tile, std::move( waited_content ) );
+			return;
+		}
+
+		++m_stats.misses;
+		SetContent( tile, ReadTile( index ) );
+	}
+
+	void StreamingQuadTree::AcceptPrefetchedTiles()
+	{
+		std::vector<PrefetchedTile> prefetched_tiles;
+		{
+			std::lock_guard<std::mutex> lock{ m_prefetch_mutex };
+			prefetched_tiles = std::exchange( m_prefetched_tiles, {} );
+		}
+
+		for( auto& prefetched_tile : prefetched_tiles )
+		{
+			Tile& tile = m_tiles[ prefetched_tile.index ];
+			tile.is_requested = false;
+			if( tile.content )
+			{
+				continue;
+			}
+
+			// Prefetched tile is treated as used by the previous searching, so it may be evicted by the current one.
+			SetContent( tile, std::move( prefetched_tile.content ) );
+			tile.last_use = m_searches_count - 1;
+			++m_stats.prefetches;
+		}
+	}
+
+	void StreamingQuadTree::RequestPrefetch( const BoundingRect& bounds )
+	{
+		if( m_tiles.empty() )
+		{
+			return;
+		}
+
+		const Vector2f min_offset{ bounds.min - m_bounds.min };
+		const Vector2f max_offset{ bounds.max - m_bounds.min };
+		const size_t min_column	= Internal::GetGridCoordinate( min_offset.x, m_tile_scale.x, m_columns );
+		const size_t min_row	= Internal::GetGridCoordinate( min_offset.y, m_tile_scale.y, m_rows );
+		const size_t max_column	= Internal::GetGridCoordinate( max_offset.x, m_tile_scale.x, m_columns );
+		const size_t max_row	= Internal::GetGridCoordinate( max_offset.y, m_tile_scale.y, m_rows );
+
+		std::vector<size_t> requested_tiles;
+		for( size_t row = min_row - std::min( min_row, PREFETCH_DISTANCE ); row <= std::min( max_row + PREFETCH_DISTANCE, m_rows - 1 ); ++row )
+		{
+			for( size_t column = min_column - std::min( min_column, PREFETCH_DISTANCE ); column <= std::min( max_column + PREFETCH_DISTANCE, m_columns - 1 ); ++column )
+			{
+				Tile& tile = m_tiles[ row * m_columns + column ];
+				if( ( tile.shapes_count == 0 ) || tile.content || tile.is_requested )
+				{
+					continue;
+				}
+
+				tile.is_requested = true;
+				requested_tiles.push_back( row * m_columns + column );
+			}
+		}
+
+		if( requested_tiles.empty() )
+		{
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock{ m_prefetch_mutex };
+			m_requested_tiles.insert( m_requested_tiles.end(), requested_tiles.begin(), requested_tiles.end() );
+		}
+
+		m_prefetch_condition.notify_all();
+	}
+
+	void StreamingQuadTree::EvictTiles()
+	{
+		while( m_stats.resident_memory > m_memory_budget )
+		{
+			Tile* evicted_tile = nullptr;
+			for( auto& tile : m_tiles )
+			{
+				if( tile.content && ( tile.last_use < m_searches_count ) && ( ( evicted_tile == nullptr ) || ( tile.last_use < evicted_tile->last_use ) ) )
+				{
+					evicted_tile = &tile;
+				}
+			}
+
+			if( evicted_tile == nullptr )
+			{
+				return;
+			}
+
+			evicted_tile->content.reset();
+			m_stats.resident_memory -= GetTileMemory( evicted_tile->shapes_count );
+			--m_stats.resident_tiles;
+			++m_stats.evictions;
+		}
+	}
+
+	void StreamingQuadTree::SetContent( Tile& tile, std::unique_ptr<TileContent> content )
+	{
+		tile.content = std::move( content );
+		m_stats.resident_memory += GetTileMemory( tile.shapes_count );
+		++m_stats.resident_tiles;
+	}
+
+	void StreamingQuadTree::RunPrefetching()
+	{
+		std::unique_lock<std::mutex> lock{ m_prefetch_mutex };
+		while( true )
+		{
+			m_prefetch_condition.wait( lock, [this]() { return m_is_stopping || !m_requested_tiles.empty(); } );
+			if( m_is_stopping )
+			{
+				return;
+			}
+
+			// The most recent requests are served first.
+			const size_t index = m_requested_tiles.back();
+			m_requested_tiles.pop_back();
+			m_reading_tile	= index;
+			m_is_reading	= true;
+			lock.unlock();
+
+			// Static tiles are completely indexed here, so the searching thread gets them ready and laid out in memory.
+			std::unique_ptr<TileContent> content{ ReadTile( index ) };
+			content->tree.Optimize();
+
+			lock.lock();
+			m_prefetched_tiles.push_back( { index, std::move( content ) } );
+			m_is_reading = false;
+			m_prefetch_condition.notify_all();
+		}
+	}
+}
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+	/**
+		@brief	Quad tree of static shapes, streamed from disk by tiles.
+
+		Streaming tree splits the world bounds into the grid of tiles. Shapes of each tile are stored in the separate file of directory,
+		written by `WriteTiles`. The directory also stores the manifest with the bounds of content and the count of shapes for each tile,
+		so only the manifest is read at construction.
+
+		Tile is paged in once the searching touches its content bounds. Shapes of tile are indexed by its own `QuadTree`.
+		Resident tiles are evicted in order of least recent use, once the estimated memory of resident tiles exceeds the budget.
+		Tiles touched by the current searching are never evicted by it, so the budget may be exceeded by a single searching.
+
+		Tiles adjacent to the searched area are requested for prefetch. Prefetched tiles are read and indexed by the background thread,
+		then they are made resident by the next searching.
+
+		Results of searching stay valid only until the next searching, since the tiles of found shapes may be evicted by it.
+		This implementation carries no thread safety, except the internal prefetching thread.
+	*/
+	class StreamingQuadTree final
+	{
+	// Public inner types.
+	public:
+		// Shape of tile tree.
+		using Shape = QuadTree::Shape;
+
+		// Collection of found shapes.
+		using QueryResult = QuadTree::QueryResult;
+
+
+		// Description of static shape, stored in tile.
+		struct ShapeRecord final
+		{
+			BoundingRect	bounds;									// Bounds of shape.
+			size_t			tag			= 0;						// Abstract tag of shape.
+			uint64_t		categories	= Shape::ALL_CATEGORIES;	// Mask of categories of shape.
+		};
+
+		// Counters of paging.
+		struct PagingStats final
+		{
+			size_t	hits				= 0;	// Count of tiles touched by searching, which were resident.
+			size_t	misses				= 0;	// Count of tiles touched by searching, which were read synchronously.
+			size_t	prefetches			= 0;	// Count of tiles paged in by prefetching before any searching waited for them.
+			size_t	evictions			= 0;	// Count of evicted tiles.
+			size_t	resident_tiles		= 0;	// Count of currently resident tiles.
+			size_t	resident_memory		= 0;	// Estimated memory of currently resident tiles, in bytes.
+		};
+
+	// Public constants.
+	public:
+		// Estimated memory of single resident shape along with its indexing, in bytes.
+		static constexpr size_t SHAPE_MEMORY_ESTIMATE = 128;
+
+		// Count of tiles around the searched area, which are requested for prefetch.
+		static constexpr size_t PREFETCH_DISTANCE = 1;
+
+	// Lifetime management.
+	public:
+		// Open the tiles, written to the directory. The tree has no tiles if the manifest of directory could not be read.
+		StreamingQuadTree( const std::filesystem::path& directory, const size_t memory_budget );
+		StreamingQuadTree( const StreamingQuadTree& ) = delete;
+		~StreamingQuadTree();
+
+
+		StreamingQuadTree& operator = ( const StreamingQuadTree& ) = delete;
+
+	// Public static interface.
+	public:
+		// Write the shapes to the directory as the grid of tiles within given bounds, along with the manifest of tiles.
+		// Each shape is stored by the tile, which region contains the center of shape bounds. Returns whether all files were written.
+		static const bool WriteTiles(
+			const std::filesystem::path& directory,
+			const BoundingRect& bounds,
+			const size_t columns,
+			const size_t rows,
+			const std::vector<ShapeRecord>& records
+		);
+
+	// Public interface.
+	public:
+		// Perform the spatial searching of shapes in given bounds. Touched tiles are paged in and adjacent tiles are prefetched.
+		QueryResult Find( const BoundingRect& bounds );
+
+		// Perform the spatial searching of shapes in given area. Touched tiles are paged in and adjacent tiles are prefetched.
+		QueryResult Find( const Vector2f& center, const float radius );
+
+
+		// Reset the counters of paging. Counts of resident tiles and memory are kept.
+		void ResetPagingStats();
+
+		// Get the counters of paging.
+		inline const PagingStats& GetPagingStats() const				{ return m_stats; };
+
+
+		// Whether the tile is resident.
+		inline const bool IsResident( const size_t index ) const		{ return m_tiles[ index ].content != nullptr; };
+
+		// Get the count of tiles.
+		inline const size_t GetTilesCount() const						{ return m_tiles.size(); };
+
+		// Get the world bounds.
+		inline const BoundingRect& GetBounds() const					{ return m_bounds; };
+
+	// Private inner types.
+	private:
+		// Resident content of tile.
+		struct TileContent final
+		{
+			QuadTree								tree;		// Tree, which indexes the shapes of tile.
+			std::vector<QuadTree::SharedShape>		shapes;		// Shapes of tile.
+		};
+
+		// Tile of world.
+		struct Tile final
+		{
+			BoundingRect					content_bounds;				// Bounds of all the shapes of tile.
+			size_t							shapes_count	= 0;		// Count of shapes stored by tile.
+			std::unique_ptr<TileContent>	content;					// Content of resident tile.
+			size_t							last_use		= 0;		// Number of searching, which used the tile last time.
+			bool							is_requested	= false;	// Whether the tile is requested for prefetch.
+		};
+
+		// Tile, paged in by the prefetching thread.
+		struct PrefetchedTile final
+		{
+			size_t							index;		// Index of tile.
+			std::unique_ptr<TileContent>	content;	// Content of tile.
+		};
+
+	// Private interface.
+	private:
+		// Perform the searching of tiles, which content intersects the given bounds.
+		template< typename TSearch >
+		QueryResult FindInTiles( const BoundingRect& bounds, TSearch&& search );
+
+
+		// Read the content of tile from its file.
+		std::unique_ptr<TileContent> ReadTile( const size_t index ) const;
+
+		// Make the tile resident, either by waiting for its prefetching or by reading it synchronously.
+		void PageIn( const size_t index );
+
+		// Make resident the tiles, already paged in by the prefetching thread.
+		void AcceptPrefetchedTiles();
+
+		// Request the prefetch of tiles around the given bounds.
+		void RequestPrefetch( const BoundingRect& bounds );
+
+		// Evict the least recently used tiles until the memory budget is met. Tiles used by current searching are kept.
+		void EvictTiles();
+
+
+		// Install the content of resident tile.
+		void SetContent( Tile& tile, std::unique_ptr<TileContent> content );
+
+		// Page in the requested tiles until the stopping.
+		void RunPrefetching();
+
+	// Private state.
+	private:
+		std::filesystem::path		m_directory;					// Directory with files of tiles.
+		std::vector<Tile>			m_tiles;						// Tiles, stored row by row.
+		BoundingRect				m_bounds;						// World bounds.
+		size_t						m_columns			= 0;		// Count of tile columns.
+		size_t						m_rows				= 0;		// Count of tile rows.
+		Vector2f					m_tile_scale{ 0.0f, 0.0f };		// Scale to translate the offset from `m_bounds.min` into tile coordinates.
+
+		size_t						m_memory_budget;				// Budget for the estimated memory of resident tiles, in bytes.
+		size_t						m_searches_count	= 0;		// Count of performed searches.
+		PagingStats					m_stats;						// Counters of paging.
+
+		std::mutex					m_prefetch_mutex;				// Guard for the state of prefetching below.
+		std::condition_variable		m_prefetch_condition;			// Notification about the new requests or prefetched tiles.
+		std::vector<size_t>			m_requested_tiles;				// Indices of tiles requested for prefetch.
+		std::vector<PrefetchedTile>	m_prefetched_tiles;				// Tiles paged in by the prefetching thread.
+		size_t						m_reading_tile		= 0;		// Index of tile, which is read by the prefetching thread.
+		bool						m_is_reading		= false;	// Whether the prefetching thread is reading the tile.
+		bool						m_is_stopping		= false;	// Whether the prefetching thread should stop.
+		std::thread					m_prefetch_thread;				// Thread to page in the requested tiles.
+	};
+}
+}
@@ -0,0 +1,47 @@
+#include <demo/spatial/spatial.h>
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+	Subscription::Subscription( QuadTree& host, const BoundingRect& bounds )
+		: m_host{ host }
+		, m_bounds{ bounds }
+		, m_watcher{ host.AddSubscription( *this ) }
+	{
+		// Index is searched directly, so the subscribing is not recorded as searching.
+		for( const auto shape : m_host.VisitBuiltIndex( [&bounds]( auto& index ) { return index.Find( bounds ); } ) )
+		{
+			m_events.push_back( { shape, EventKind::Enter } );
+		}
+	}
+
+	Subscription::~Subscription()
+	{
+		m_host.RemoveSubscription( *this );
+	}
+
+	void Subscription::SetBounds( const BoundingRect& bounds )
+	{
+		const BoundingRect previous_bounds{ std::exchange( m_bounds, bounds ) };
+		m_watcher->SetBounds( bounds );
+
+		const BoundingRect swept_bounds{ BoundingRect{ previous_bounds }.Grow( bounds ) };
+		for( const auto shape : m_host.VisitBuiltIndex( [&swept_bounds]( auto& index ) { return index.Find( swept_bounds ); } ) )
+		{
+			const bool was_inside	= previous_bounds.IsIntersects( shape->GetBounds() );
+			const bool is_inside	= bounds.IsIntersects( shape->GetBounds() );
+			if( was_inside != is_inside )
+			{
+				m_events.push_back( { shape, is_inside? EventKind::Enter : EventKind::Leave } );
+			}
+		}
+	}
+
+	std::vector<Subscription::Event> Subscription::TakeEvents()
+	{
+		return std::exchange( m_events, {} );
+	}
+}
+}
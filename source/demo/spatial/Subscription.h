@@ -0,0 +1,73 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+	/**
+		@brief	Subscription to the changes of shapes in the region of quad tree.
+
+		Subscription collects the events about the shapes, which enter or leave its bounds. Shape enters the bounds once it starts
+		to intersect them, either by the moving or by the acquiring. Shape leaves the bounds once it stops to intersect them,
+		either by the moving or by the releasing. Initially all the shapes, intersecting the bounds, are reported as entered.
+
+		Subscriptions are indexed by the own tree of quad tree, so only the subscriptions near the changed shape are notified.
+		The cost of notification is proportional to the count of changes, rather than to the count of shapes in bounds.
+
+		Events are collected in order of changes, so the same shape may enter and leave the bounds several times until the taking of events.
+		Shape of leave event may be already released, so it should be used only as a key to identify the shape entered before.
+		Subscription should be released before its quad tree.
+	*/
+	class Subscription final
+	{
+	// Public inner types and friendship declarations.
+	public:
+		// Allow the quad tree to push the events.
+		friend class QuadTree;
+
+
+		// Kind of subscription event.
+		enum class EventKind : uint8_t
+		{
+			Enter,	// Shape started to intersect the bounds of subscription.
+			Leave,	// Shape stopped to intersect the bounds of subscription.
+		};
+
+		// Event of subscription.
+		struct Event final
+		{
+			const QuadTree::Shape*	shape;	// Shape, which entered or left the bounds.
+			EventKind				kind;	// Kind of event.
+		};
+
+	// Lifetime management.
+	public:
+		Subscription( QuadTree& host, const BoundingRect& bounds );
+		Subscription( const Subscription& ) = delete;
+		~Subscription();
+
+
+		Subscription& operator = ( const Subscription& ) = delete;
+
+	// Public interface.
+	public:
+		// Set new bounds of subscription. Shapes in the difference of previous and new bounds are reported.
+		void SetBounds( const BoundingRect& bounds );
+
+		// Take the events, collected since the previous taking.
+		std::vector<Event> TakeEvents();
+
+
+		// Get current bounds of subscription.
+		inline const BoundingRect& GetBounds() const		{ return m_bounds; };
+
+	// Private state.
+	private:
+		QuadTree&				m_host;			// Quad tree that host subscription.
+		BoundingRect			m_bounds;		// Bounds of subscription.
+		QuadTree::SharedShape	m_watcher;		// Shape of subscription in the tree of subscriptions.
+		std::vector<Event>		m_events;		// Events collected since the previous taking.
+	};
+}
+}
@@ -0,0 +1,319 @@
+#include <demo/spatial/spatial.h>
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+namespace
+{
+	// Signature of the trace file.
+	constexpr uint32_t TRACE_SIGNATURE = 0x52545144;
+
+
+	// Write the trivially copyable value to the binary stream.
+	template< typename TValue >
+	void WriteValue( std::ostream& stream, const TValue& value )
+	{
+		stream.write( reinterpret_cast<const char*>( &value ), sizeof( TValue ) );
+	}
+
+	// Read the trivially copyable value from the binary stream. Returns whether the value was read.
+	template< typename TValue >
+	const bool ReadValue( std::istream& stream, TValue& value )
+	{
+		return bool( stream.read( reinterpret_cast<char*>( &value ), sizeof( TValue ) ) );
+	}
+
+	// Write the count, narrowed to 32 bits, to the binary stream.
+	void WriteCount( std::ostream& stream, const size_t count )
+	{
+		WriteValue( stream, uint32_t( std::min<size_t>( count, std::numeric_limits<uint32_t>::max() ) ) );
+	}
+
+	// Read the count, narrowed to 32 bits, from the binary stream. Returns whether the count was read.
+	const bool ReadCount( std::istream& stream, size_t& count )
+	{
+		uint32_t value = 0;
+		const bool is_read = ReadValue( stream, value );
+		count = value;
+
+		return is_read;
+	}
+
+	// Write the options of searching to the binary stream.
+	void WriteOptions( std::ostream& stream, const QueryOptions& options )
+	{
+		WriteValue( stream, options.order );
+		WriteValue( stream, options.origin );
+		WriteValue( stream, options.deduplicate );
+	}
+
+	// Read the options of searching from the binary stream. Returns whether the options were read.
+	const bool ReadOptions( std::istream& stream, QueryOptions& options )
+	{
+		return ReadValue( stream, options.order ) && ReadValue( stream, options.origin ) && ReadValue( stream, options.deduplicate );
+	}
+
+	// Write the fields of searching event, which are meaningful for its operation, to the binary stream.
+	void WriteFindEvent( std::ostream& stream, const TraceRecorder::Event& event )
+	{
+		using Operation = TraceRecorder::Operation;
+
+		switch( event.operation )
+		{
+			case Operation::FindHinted:
+				WriteValue( stream, event.shape_id );
+				WriteValue( stream, event.bounds );
+				break;
+
+			case Operation::FindCategories:
+				WriteValue( stream, event.bounds );
+				WriteValue( stream, event.categories );
+				break;
+
+			case Operation::FindChangedSince:
+				WriteValue( stream, event.bounds );
+				WriteValue( stream, event.epoch );
+				break;
+
+			case Operation::FindCircle:
+			case Operation::FindCircleOrdered:
+				WriteValue( stream, event.bounds.min );
+				WriteValue( stream, event.radius );
+				if( event.operation == Operation::FindCircleOrdered )
+				{
+					WriteOptions( stream, event.options );
+				}
+				break;
+
+			case Operation::FindPolygon:
+				WriteCount( stream, event.vertices.size() );
+				stream.write( reinterpret_cast<const char*>( event.vertices.data() ), event.vertices.size() * sizeof( Vector2f ) );
+				break;
+
+			case Operation::FindOrdered:
+				WriteValue( stream, event.bounds );
+				WriteOptions( stream, event.options );
+				break;
+
+			case Operation::FindSwept:
+				WriteValue( stream, event.bounds );
+				WriteValue( stream, event.displacement );
+				WriteValue( stream, event.is_first_hit_only );
+				break;
+
+			case Operation::FindTop:
+				WriteValue( stream, event.bounds );
+				WriteCount( stream, event.count );
+				WriteValue( stream, event.key );
+				WriteValue( stream, uint64_t( event.visits_budget ) );
+				break;
+
+			case Operation::Histogram:
+				WriteValue( stream, event.bounds );
+				WriteCount( stream, event.columns );
+				WriteCount( stream, event.rows );
+				break;
+
+			default:
+				WriteValue( stream, event.bounds );
+				break;
+		}
+	}
+
+	// Read the fields of event, which are meaningful for its already read operation. Returns whether the event was completely read.
+	const bool ReadEvent( std::istream& stream, TraceRecorder::Event& event )
+	{
+		using Operation = TraceRecorder::Operation;
+
+		switch( event.operation )
+		{
+			case Operation::Acquire:
+			case Operation::Move:
+			case Operation::FindHinted:
+				return ReadValue( stream, event.shape_id ) && ReadValue( stream, event.bounds );
+
+			case Operation::Release:
+				return ReadValue( stream, event.shape_id );
+
+			case Operation::AdvanceEpoch:
+				return true;
+
+			case Operation::Categorize:
+				return ReadValue( stream, event.shape_id ) && ReadValue( stream, event.categories );
+
+			case Operation::FindCategories:
+				return ReadValue( stream, event.bounds ) && ReadValue( stream, event.categories );
+
+			case Operation::FindChangedSince:
+				return ReadValue( stream, event.bounds ) && ReadValue( stream, event.epoch );
+
+			case Operation::FindCircle:
+			case Operation::FindCircleOrdered:
+			{
+				Vector2f center{ 0.0f, 0.0f };
+				if( !ReadValue( stream, center ) || !ReadValue( stream, event.radius ) )
+				{
+					return false;
+				}
+
+				event.bounds = BoundingRect{ center };
+				return ( event.operation == Operation::FindCircle ) || ReadOptions( stream, event.options );
+			}
+
+			case Operation::FindPolygon:
+			{
+				size_t vertices_count = 0;
+				if( !ReadCount( stream, vertices_count ) )
+				{
+					return false;
+				}
+
+				event.vertices.resize( vertices_count );
+				return bool( stream.read( reinterpret_cast<char*>( event.vertices.data() ), vertices_count * sizeof( Vector2f ) ) );
+			}
+
+			case Operation::FindOrdered:
+				return ReadValue( stream, event.bounds ) && ReadOptions( stream, event.options );
+
+			case Operation::FindSwept:
+				return ReadValue( stream, event.bounds ) && ReadValue( stream, event.displacement ) && ReadValue( stream, event.is_first_hit_only );
+
+			case Operation::FindTop:
+			{
+				uint64_t visits_budget = 0;
+				const bool is_read = ReadValue( stream, event.bounds ) && ReadCount( stream, event.count ) && ReadValue( stream, event.key )
+					&& ReadValue( stream, visits_budget );
+				event.visits_budget = size_t( std::min<uint64_t>( visits_budget, std::numeric_limits<size_t>::max() ) );
+
+				return is_read;
+			}
+
+			case Operation::Histogram:
+				return ReadValue( stream, event.bounds ) && ReadCount( stream, event.columns ) && ReadCount( stream, event.rows );
+
+			case Operation::Find:
+			case Operation::Any:
+			case Operation::Count:
+				return ReadValue( stream, event.bounds );
+		}
+
+		// Unknown operation.
+		return false;
+	}
+}
+
+
+	TraceRecorder::TraceRecorder( const std::filesystem::path& path )
+		: m_stream{ path, std::ios::binary | std::ios::trunc }
+	{
+		WriteValue( m_stream, TRACE_SIGNATURE );
+	}
+
+	std::vector<TraceRecorder::Event> TraceRecorder::Load( const std::filesystem::path& path )
+	{
+		std::vector<Event> result;
+
+		std::ifstream stream{ path, std::ios::binary };
+		uint32_t signature = 0;
+		if( !ReadValue( stream, signature ) || ( signature != TRACE_SIGNATURE ) )
+		{
+			return result;
+		}
+
+		Event event;
+		while( ReadValue( stream, event.operation ) )
+		{
+			if( ( event.operation > Operation::Histogram ) || !ReadEvent( stream, event ) )
+			{
+				break;
+			}
+
+			result.push_back( std::move( event ) );
+			event = {};
+		}
+
+		return result;
+	}
+
+	void TraceRecorder::RecordAcquire( const QuadTree::Shape& shape )
+	{
+		const uint32_t shape_id = m_next_shape_id++;
+		m_shape_ids[ &shape ] = shape_id;
+
+		WriteValue( m_stream, Operation::Acquire );
+		WriteValue( m_stream, shape_id );
+		WriteValue( m_stream, shape.GetBounds() );
+		++m_events_count;
+	}
+
+	void TraceRecorder::RecordRelease( const QuadTree::Shape& shape )
+	{
+		// Shapes acquired before the installation of recorder are not recorded.
+		const auto found_id = m_shape_ids.find( &shape );
+		if( found_id == m_shape_ids.end() )
+		{
+			return;
+		}
+
+		WriteValue( m_stream, Operation::Release );
+		WriteValue( m_stream, found_id->second );
+		++m_events_count;
+
+		m_shape_ids.erase( found_id );
+	}
+
+	void TraceRecorder::RecordMove( const QuadTree::Shape& shape )
+	{
+		const auto found_id = m_shape_ids.find( &shape );
+		if( found_id == m_shape_ids.end() )
+		{
+			return;
+		}
+
+		WriteValue( m_stream, Operation::Move );
+		WriteValue( m_stream, found_id->second );
+		WriteValue( m_stream, shape.GetBounds() );
+		++m_events_count;
+	}
+
+	void TraceRecorder::RecordCategorize( const QuadTree::Shape& shape )
+	{
+		const auto found_id = m_shape_ids.find( &shape );
+		if( found_id == m_shape_ids.end() )
+		{
+			return;
+		}
+
+		WriteValue( m_stream, Operation::Categorize );
+		WriteValue( m_stream, found_id->second );
+		WriteValue( m_stream, shape.GetCategories() );
+		++m_events_count;
+	}
+
+	void TraceRecorder::RecordAdvanceEpoch()
+	{
+		WriteValue( m_stream, Operation::AdvanceEpoch );
+		++m_events_count;
+	}
+
+	void TraceRecorder::RecordFind( const Event& event )
+	{
+		WriteValue( m_stream, event.operation );
+		WriteFindEvent( m_stream, event );
+		++m_events_count;
+	}
+
+	const uint32_t TraceRecorder::GetHintId( const QueryHint& hint )
+	{
+		const auto [ found_id, is_new ] = m_hint_ids.try_emplace( &hint, m_next_hint_id );
+		if( is_new )
+		{
+			++m_next_hint_id;
+		}
+
+		return found_id->second;
+	}
+}
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+	/**
+		@brief	Recorder of quad tree workload.
+
+		Recorder writes the compact binary trace of calls to the quad tree, which the recorder is installed to by `QuadTree::SetTraceRecorder`.
+		Acquiring, releasing, moving and categorizing of shapes and the advancing of epochs are recorded along with each kind of searching
+		and its parameters.
+		Each event stores in trace only the fields, which are meaningful for its operation. Shapes are identified in trace by sequential
+		numbers, given on acquiring. Hints of searching are identified by sequential numbers too, given on their first use.
+		Joining of quad trees and subscriptions, including their searching of shapes and notifications, are not recorded.
+
+		Recorded trace may be loaded by `Load` to replay the workload against different configurations of quad tree.
+		Recorder should outlive the recording quad tree or be removed from it before the destruction.
+	*/
+	class TraceRecorder final
+	{
+	// Public inner types.
+	public:
+		// Kind of recorded operation.
+		enum class Operation : uint8_t
+		{
+			Acquire,	// The shape with given identifier was acquired with given bounds.
+			Release,	// The shape with given identifier was released.
+			Move,		// The shape with given identifier was moved to given bounds.
+			Find,		// The shapes were searched in given bounds.
+
+			Categorize,			// The shape with given identifier changed its categories to given ones.
+			AdvanceEpoch,		// The next epoch of changes was started.
+			FindHinted,			// The shapes were searched in given bounds with the hint of given identifier.
+			FindCategories,		// The shapes of given categories were searched in given bounds.
+			FindChangedSince,	// The shapes changed since given epoch were searched in given bounds.
+			FindCircle,			// The shapes were searched in the circle of given center and radius.
+			FindPolygon,		// The shapes were searched in the convex polygon of given vertices.
+			FindOrdered,		// The shapes were searched in given bounds and ordered by given options.
+			FindCircleOrdered,	// The shapes were searched in the circle of given center and radius and ordered by given options.
+			FindSwept,			// The shapes were searched by given bounds, moving along given displacement.
+			Any,				// The presence of shapes was checked in given bounds.
+			Count,				// The shapes were counted in given bounds.
+			FindTop,			// The largest shapes were searched in given bounds with given count, key and budget of visits.
+			Histogram,			// The histogram of given columns and rows was aggregated over given bounds.
+		};
+
+		// Recorded event. Fields, which are not used by the operation, keep their default values.
+		struct Event final
+		{
+			Operation				operation			= Operation::Find;	// Kind of operation.
+			uint32_t				shape_id			= 0;				// Identifier of shape or of searching hint.
+			BoundingRect			bounds;									// Bounds of shape or searching. Center of circle is given as point bounds.
+			float					radius				= 0.0f;				// Radius of searched circle.
+			uint64_t				categories			= 0;				// Categories of shape or searching.
+			uint64_t				epoch				= 0;				// Epoch, which the changed shapes were searched since.
+			QueryOptions			options;								// Options of ordered searching.
+			Vector2f				displacement{ 0.0f, 0.0f };				// Displacement of swept searching.
+			bool					is_first_hit_only	= false;			// Whether only the earliest hit was searched by swept searching.
+			size_t					count				= 0;				// Count of searched largest shapes.
+			SizeKey					key					= SizeKey::Area;	// Key to measure the largest shapes.
+			size_t					visits_budget		= 0;				// Budget of visits for the searching of largest shapes.
+			size_t					columns				= 0;				// Count of histogram columns.
+			size_t					rows				= 0;				// Count of histogram rows.
+			std::vector<Vector2f>	vertices;								// Vertices of searched polygon.
+		};
+
+	// Lifetime management.
+	public:
+		explicit TraceRecorder( const std::filesystem::path& path );
+		TraceRecorder( const TraceRecorder& ) = delete;
+		inline ~TraceRecorder() noexcept = default;
+
+
+		TraceRecorder& operator = ( const TraceRecorder& ) = delete;
+
+	// Public static interface.
+	public:
+		// Load all the events of trace. Returns an empty collection if the trace could not be read.
+		static std::vector<Event> Load( const std::filesystem::path& path );
+
+	// Public interface.
+	public:
+		// Whether the trace file is open for recording.
+		inline const bool IsOpen() const		{ return m_stream.is_open() && m_stream.good(); };
+
+		// Get the count of recorded events.
+		inline const size_t GetEventsCount() const	{ return m_events_count; };
+
+	// Private interface.
+	private:
+		// Allow the quad tree to record the events.
+		friend class QuadTree;
+
+
+		// Record the acquiring of shape. The shape receives the next identifier.
+		void RecordAcquire( const QuadTree::Shape& shape );
+
+		// Record the releasing of shape.
+		void RecordRelease( const QuadTree::Shape& shape );
+
+		// Record the moving of shape to its current bounds.
+		void RecordMove( const QuadTree::Shape& shape );
+
+		// Record the changing of shape categories to its current ones.
+		void RecordCategorize( const QuadTree::Shape& shape );
+
+		// Record the start of the next epoch of changes.
+		void RecordAdvanceEpoch();
+
+		// Record the searching described by event.
+		void RecordFind( const Event& event );
+
+		// Get the identifier of hint. The hint receives the next identifier at its first use.
+		const uint32_t GetHintId( const QueryHint& hint );
+
+	// Private state.
+	private:
+		std::ofstream										m_stream;				// Stream of trace file.
+		std::unordered_map<const QuadTree::Shape*, uint32_t>	m_shape_ids;			// Identifiers of alive recorded shapes.
+		std::unordered_map<const QueryHint*, uint32_t>		m_hint_ids;				// Identifiers of used hints.
+		uint32_t											m_next_shape_id	= 0;	// Identifier for the next acquired shape.
+		uint32_t											m_next_hint_id	= 0;	// Identifier for the next used hint.
+		size_t												m_events_count	= 0;	// Count of recorded events.
+	};
+}
+}
@@ -7,5 +7,14 @@ inline namespace Spatial
 {
 	// Allow to reference from internal code.
 	class QuadTree;
+
+	// Allow to reference from internal code.
+	class QueryHint;
+
+	// Allow to reference from quad tree.
+	class Subscription;
+
+	// Allow to reference from quad tree.
+	class TraceRecorder;
 }
 }
@@ -0,0 +1,22 @@
+#include <demo/spatial/spatial.h>
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+namespace Internal
+{
+	const float GetGridScale( const float size, const size_t count )
+	{
+		return ( size > 0.0f )? float( count ) / size : 0.0f;
+	}
+
+	const size_t GetGridCoordinate( const float offset, const float scale, const size_t count )
+	{
+		const float coordinate = std::floor( offset * scale );
+		return size_t( std::clamp( coordinate, 0.0f, float( count - 1 ) ) );
+	}
+}
+}
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+namespace Internal
+{
+	// Get the scale to translate the offset along single axis into the coordinate of grid with given count of cells along the axis.
+	const float GetGridScale( const float size, const size_t count );
+
+	// Translate the offset along single axis into the coordinate of grid cell. Offsets out of grid are clamped to its border cells.
+	const size_t GetGridCoordinate( const float offset, const float scale, const size_t count );
+}
+}
+}
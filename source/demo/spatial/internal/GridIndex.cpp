@@ -0,0 +1,318 @@
+#include <demo/spatial/spatial.h>
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+namespace Internal
+{
+namespace
+{
+	// Get the bounding rect of searching area.
+	const Demo::BoundingRect& GetAreaBounds( const Demo::BoundingRect& area )
+	{
+		return area;
+	}
+
+	// Get the bounding rect of searching area.
+	const Demo::BoundingRect& GetAreaBounds( const ConvexPolygon& area )
+	{
+		return area.GetBounds();
+	}
+}
+
+
+	void GridIndex::Reset()
+	{
+		m_cells.clear();
+	}
+
+	void GridIndex::Build( const Demo::BoundingRect& bounds )
+	{
+		const Vector2f size{ bounds.GetSize() };
+
+		m_bounds		= bounds;
+		m_cell_scale	= { GetGridScale( size.x, CELLS_PER_AXIS ), GetGridScale( size.y, CELLS_PER_AXIS ) };
+		m_cells.assign( CELLS_PER_AXIS * CELLS_PER_AXIS, {} );
+
+		m_shapes.erase( std::remove( m_shapes.begin(), m_shapes.end(), nullptr ), m_shapes.end() );
+		for( const auto shape : m_shapes )
+		{
+			IndexShape( *shape, GetCellRange( shape->GetBounds() ) );
+		}
+	}
+
+	void GridIndex::Push( const Shape& shape )
+	{
+		m_shapes.push_back( &shape );
+		if( IsBuilt() )
+		{
+			IndexShape( shape, GetCellRange( shape.GetBounds() ) );
+		}
+	}
+
+	void GridIndex::Pop( const Shape& shape )
+	{
+		*std::find( m_shapes.begin(), m_shapes.end(), &shape ) = nullptr;
+
+		if( IsBuilt() )
+		{
+			UnindexShape( shape, GetCellRange( shape.GetBounds() ) );
+		}
+	}
+
+	void GridIndex::Move( const Shape& shape, const Demo::BoundingRect& previous_bounds )
+	{
+		if( IsEmpty() )
+		{
+			return;
+		}
+
+		const CellRange previous_range{ GetCellRange( previous_bounds ) };
+		const CellRange current_range{ GetCellRange( shape.GetBounds() ) };
+		if( std::tie( previous_range.min_column, previous_range.min_row, previous_range.max_column, previous_range.max_row )
+			== std::tie( current_range.min_column, current_range.min_row, current_range.max_column, current_range.max_row ) )
+		{
+			return;
+		}
+
+		UnindexShape( shape, previous_range );
+		IndexShape( shape, current_range );
+	}
+
+	QueryResult GridIndex::Find( const Demo::BoundingRect& bounds ) const
+	{
+		return FindInArea( bounds );
+	}
+
+	QueryResult GridIndex::Find( const Demo::BoundingRect& bounds, const uint64_t categories ) const
+	{
+		QueryResult result{ GetQueryResource() };
+		VisitShapes(
+			bounds,
+			[&result, categories]( const Shape* shape )
+			{
+				if( ( shape->GetCategories() & categories ) != 0 )
+				{
+					result.push_back( shape );
+				}
+
+				return true;
+			}
+		);
+
+		return result;
+	}
+
+	QueryResult GridIndex::FindChangedSince( const Demo::BoundingRect& bounds, const uint64_t epoch ) const
+	{
+		QueryResult result{ GetQueryResource() };
+		VisitShapes(
+			bounds,
+			[&result, epoch]( const Shape* shape )
+			{
+				if( shape->GetEpoch() >= epoch )
+				{
+					result.push_back( shape );
+				}
+
+				return true;
+			}
+		);
+
+		return result;
+	}
+
+	QueryResult GridIndex::Find( const ConvexPolygon& polygon ) const
+	{
+		return FindInArea( polygon );
+	}
+
+	SweepResult GridIndex::FindSwept( const Demo::BoundingRect& bounds, const Vector2f& displacement, const bool is_first_hit_only ) const
+	{
+		SweepResult result{ GetQueryResource() };
+
+		const Demo::BoundingRect swept_bounds{ Demo::BoundingRect{ bounds }.Grow( { bounds.min + displacement, bounds.max + displacement, std::ignore } ) };
+		VisitShapes(
+			swept_bounds,
+			[&result, &bounds, &displacement]( const Shape* shape )
+			{
+				const float time = bounds.GetSweepTime( shape->GetBounds(), displacement );
+				if( !std::isinf( time ) )
+				{
+					result.push_back( { shape, time } );
+				}
+
+				return true;
+			}
+		);
+
+		if( is_first_hit_only && !result.empty() )
+		{
+			const SweepHit first_hit{ *std::min_element(
+				result.begin(),
+				result.end(),
+				[]( const SweepHit& left, const SweepHit& right ) { return left.time < right.time; }
+			) };
+
+			result.assign( 1, first_hit );
+			return result;
+		}
+
+		OrderHits( result );
+		return result;
+	}
+
+	const bool GridIndex::Any( const Demo::BoundingRect& bounds ) const
+	{
+		return !VisitShapes( bounds, []( const Shape* ) { return false; } );
+	}
+
+	const size_t GridIndex::Count( const Demo::BoundingRect& bounds ) const
+	{
+		size_t result = 0;
+		VisitShapes( bounds, [&result]( const Shape* ) { ++result; return true; } );
+
+		return result;
+	}
+
+	HistogramResult GridIndex::Histogram( const Demo::BoundingRect& bounds, const size_t columns, const size_t rows ) const
+	{
+		HistogramResult result{ columns * rows, HistogramCell{}, GetQueryResource() };
+		if( result.empty() )
+		{
+			return result;
+		}
+
+		const HistogramGrid grid{ bounds, columns, rows };
+		for( const auto shape : m_shapes )
+		{
+			if( ( shape == nullptr ) || !bounds.ConsistsOf( shape->GetBounds().GetCenter() ) )
+			{
+				continue;
+			}
+
+			const Vector2f size{ shape->GetBounds().GetSize() };
+
+			HistogramCell& cell = result[ grid.GetCellIndex( shape->GetBounds().GetCenter() ) ];
+			++cell.shapes_count;
+			cell.shapes_area += double( size.x ) * double( size.y );
+		}
+
+		return result;
+	}
+
+	QueryResult GridIndex::FindTop( const Demo::BoundingRect& bounds, const size_t count, const SizeKey key, const size_t visits_budget ) const
+	{
+		TopShapes top_shapes{ count, key };
+		if( !bounds.IsIntersects( m_bounds ) )
+		{
+			return top_shapes.TakeResult();
+		}
+
+		size_t visits_count = 0;
+		const CellRange range{ GetCellRange( bounds ) };
+		for( size_t row = range.min_row; ( row <= range.max_row ) && ( visits_count < visits_budget ); ++row )
+		{
+			for( size_t column = range.min_column; ( column <= range.max_column ) && ( visits_count < visits_budget ); ++column, ++visits_count )
+			{
+				for( const auto shape : GetCell( column, row ) )
+				{
+					// The shape is offered only by the first cell, shared by the ranges of query and shape.
+					const CellRange shape_range{ GetCellRange( shape->GetBounds() ) };
+					if( ( column == std::max( range.min_column, shape_range.min_column ) ) && ( row == std::max( range.min_row, shape_range.min_row ) )
+						&& bounds.IsIntersects( shape->GetBounds() ) )
+					{
+						top_shapes.Push( *shape );
+					}
+				}
+			}
+		}
+
+		return top_shapes.TakeResult();
+	}
+
+	template< typename TArea >
+	QueryResult GridIndex::FindInArea( const TArea& area ) const
+	{
+		QueryResult result{ GetQueryResource() };
+		VisitShapes( area, [&result]( const Shape* shape ) { result.push_back( shape ); return true; } );
+
+		return result;
+	}
+
+	template< typename TArea, typename TVisitor >
+	const bool GridIndex::VisitShapes( const TArea& area, TVisitor&& visitor ) const
+	{
+		if( !area.IsIntersects( m_bounds ) )
+		{
+			return true;
+		}
+
+		const CellRange range{ GetCellRange( GetAreaBounds( area ) ) };
+		for( size_t row = range.min_row; row <= range.max_row; ++row )
+		{
+			for( size_t column = range.min_column; column <= range.max_column; ++column )
+			{
+				for( const auto shape : GetCell( column, row ) )
+				{
+					// The shape is reported only by the first cell, shared by the ranges of query and shape.
+					const CellRange shape_range{ GetCellRange( shape->GetBounds() ) };
+					if( ( column != std::max( range.min_column, shape_range.min_column ) ) || ( row != std::max( range.min_row, shape_range.min_row ) ) )
+					{
+						continue;
+					}
+
+					if( area.IsIntersects( shape->GetBounds() ) && !visitor( shape ) )
+					{
+						return false;
+					}
+				}
+			}
+		}
+
+		return true;
+	}
+
+	GridIndex::CellRange GridIndex::GetCellRange( const Demo::BoundingRect& bounds ) const
+	{
+		const Vector2f min_offset{ bounds.min - m_bounds.min };
+		const Vector2f max_offset{ bounds.max - m_bounds.min };
+
+		return {
+			GetGridCoordinate( min_offset.x, m_cell_scale.x, CELLS_PER_AXIS ),
+			GetGridCoordinate( min_offset.y, m_cell_scale.y, CELLS_PER_AXIS ),
+			GetGridCoordinate( max_offset.x, m_cell_scale.x, CELLS_PER_AXIS ),
+			GetGridCoordinate( max_offset.y, m_cell_scale.y, CELLS_PER_AXIS ),
+		};
+	}
+
+	void GridIndex::IndexShape( const Shape& shape, const CellRange& range )
+	{
+		for( size_t row = range.min_row; row <= range.max_row; ++row )
+		{
+			for( size_t column = range.min_column; column <= range.max_column; ++column )
+			{
+				GetCell( column, row ).push_back( &shape );
+			}
+		}
+	}
+
+	void GridIndex::UnindexShape( const Shape& shape, const CellRange& range )
+	{
+		for( size_t row = range.min_row; row <= range.max_row; ++row )
+		{
+			for( size_t column = range.min_column; column <= range.max_column; ++column )
+			{
+				Shapes& cell = GetCell( column, row );
+
+				auto found_slot = std::find( cell.begin(), cell.end(), &shape );
+				std::swap( *found_slot, cell.back() );
+				cell.pop_back();
+			}
+		}
+	}
+}
+}
+}
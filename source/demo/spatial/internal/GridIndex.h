@@ -0,0 +1,125 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+namespace Internal
+{
+	/**
+		@brief	Indexing uniform grid.
+
+		This type is an alternative to `IndexTree` with the same interface. It splits the indexing bounds into `CELLS_PER_AXIS` x `CELLS_PER_AXIS` cells.
+		Each shape is indexed by every cell it overlaps, so the inserting and the moving of shape costs only the count of overlapped cells.
+		The grid is suitable for densely and uniformly populated spaces, where shapes are small relative to the indexing bounds.
+
+		Just like `IndexTree`, the managing of grid state should be made externally. This grid does not rebuild or reset itself.
+	*/
+	class GridIndex final
+	{
+	// Public constants.
+	public:
+		// Count of cells along each axis of the grid.
+		static constexpr size_t CELLS_PER_AXIS = 32;
+
+	public:
+		// Reset the indexing grid. Building of grid is required after reset and before the searching.
+		void Reset();
+
+		// Build the indexing grid within the given bounds.
+		void Build( const Demo::BoundingRect& bounds );
+
+
+		// Push the shape to indexing grid.
+		void Push( const Shape& shape );
+
+		// Pop the shape from indexing grid.
+		void Pop( const Shape& shape );
+
+		// Re-index the shape, that was moved from `previous_bounds` to its current bounds.
+		void Move( const Shape& shape, const Demo::BoundingRect& previous_bounds );
+
+		// Search for indexed shapes in a given bounds.
+		QueryResult Find( const Demo::BoundingRect& bounds ) const;
+
+		// Search for indexed shapes in a given bounds, which belong to any of given categories.
+		QueryResult Find( const Demo::BoundingRect& bounds, const uint64_t categories ) const;
+
+		// Search for indexed shapes in a given bounds, which were changed at given epoch or later.
+		QueryResult FindChangedSince( const Demo::BoundingRect& bounds, const uint64_t epoch ) const;
+
+		// Search for indexed shapes in a given convex polygon.
+		QueryResult Find( const ConvexPolygon& polygon ) const;
+
+		// Search for indexed shapes hit by the bounds, moving along the displacement. Result is ordered by the time of impact.
+		// Cells are searched within the union of start and end bounds. Only the earliest hit is kept if `is_first_hit_only` is set.
+		SweepResult FindSwept( const Demo::BoundingRect& bounds, const Vector2f& displacement, const bool is_first_hit_only ) const;
+
+		// Whether any indexed shape lies in a given bounds. Searching stops at first found shape.
+		const bool Any( const Demo::BoundingRect& bounds ) const;
+
+		// Count the indexed shapes in a given bounds.
+		const size_t Count( const Demo::BoundingRect& bounds ) const;
+
+		// Aggregate the indexed shapes by cells of the grid over given bounds. Shape is accounted by the cell, which contains its center.
+		// Each indexed shape is visited once, since the cells of index store no totals.
+		HistogramResult Histogram( const Demo::BoundingRect& bounds, const size_t columns, const size_t rows ) const;
+
+		// Search for up to `count` largest indexed shapes in a given bounds, measured by the key. Result is ordered by descending size.
+		// Cells store no limits of shape sizes, so each cell in bounds is searched, until `visits_budget` cells were visited.
+		QueryResult FindTop( const Demo::BoundingRect& bounds, const size_t count, const SizeKey key, const size_t visits_budget ) const;
+
+		// Whether the grid is empty (not built).
+		inline const bool IsEmpty() const			{ return m_cells.empty(); };
+
+		// Whether the grid is built.
+		inline const bool IsBuilt() const			{ return !m_cells.empty(); };
+
+	private:
+		// Range of cells, given by inclusive minimum and maximum cell coordinates.
+		struct CellRange final
+		{
+			size_t min_column;
+			size_t min_row;
+			size_t max_column;
+			size_t max_row;
+		};
+
+
+		// Search for indexed shapes in a given area. The area should be able to give its bounds and to intersect the bounding rects.
+		template< typename TArea >
+		QueryResult FindInArea( const TArea& area ) const;
+
+		// Visit each indexed shape in a given area just once. Visiting stops once the visitor returns `false`.
+		// Returns `false` if the visiting was stopped.
+		template< typename TArea, typename TVisitor >
+		const bool VisitShapes( const TArea& area, TVisitor&& visitor ) const;
+
+
+		// Get the range of cells overlapped by given bounds.
+		CellRange GetCellRange( const Demo::BoundingRect& bounds ) const;
+
+		// Get the cell by its coordinates.
+		inline Shapes& GetCell( const size_t column, const size_t row )					{ return m_cells[ row * CELLS_PER_AXIS + column ]; };
+
+		// Get the cell by its coordinates.
+		inline const Shapes& GetCell( const size_t column, const size_t row ) const		{ return m_cells[ row * CELLS_PER_AXIS + column ]; };
+
+
+		// Index the shape in each cell of given range.
+		void IndexShape( const Shape& shape, const CellRange& range );
+
+		// Remove the shape from each cell of given range.
+		void UnindexShape( const Shape& shape, const CellRange& range );
+
+	private:
+		Shapes				m_shapes;						// Collection of shapes to be indexed.
+
+		std::vector<Shapes>	m_cells;						// Cells of grid, stored row by row.
+		Demo::BoundingRect	m_bounds;						// Bounds of indexing.
+		Vector2f			m_cell_scale{ 0.0f, 0.0f };		// Scale to translate the offset from `m_bounds.min` into cell coordinates.
+	};
+}
+}
+}
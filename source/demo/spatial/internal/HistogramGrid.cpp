@@ -0,0 +1,25 @@
+#include <demo/spatial/spatial.h>
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+namespace Internal
+{
+	HistogramGrid::HistogramGrid( const Demo::BoundingRect& bounds, const size_t columns, const size_t rows )
+		: m_bounds{ bounds }
+		, m_columns{ columns }
+		, m_rows{ rows }
+		, m_scale{ GetGridScale( bounds.GetSize().x, columns ), GetGridScale( bounds.GetSize().y, rows ) }
+	{
+	}
+
+	const size_t HistogramGrid::GetCellIndex( const Vector2f& point ) const
+	{
+		const Vector2f offset{ point - m_bounds.min };
+		return GetGridCoordinate( offset.y, m_scale.y, m_rows ) * m_columns + GetGridCoordinate( offset.x, m_scale.x, m_columns );
+	}
+}
+}
+}
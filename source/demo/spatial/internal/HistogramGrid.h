@@ -0,0 +1,39 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+namespace Internal
+{
+	/**
+		@brief	Grid of histogram cells over the bounds.
+
+		Grid translates the points into indices of histogram cells, which are stored row by row.
+		Points on the maximum edges of bounds belong to the last cells of rows and columns.
+	*/
+	class HistogramGrid final
+	{
+	// Lifetime management.
+	public:
+		HistogramGrid( const Demo::BoundingRect& bounds, const size_t columns, const size_t rows );
+
+	// Public interface.
+	public:
+		// Get the index of cell, which contains the given point. Points outside the bounds belong to the border cells.
+		const size_t GetCellIndex( const Vector2f& point ) const;
+
+		// Get the bounds of grid.
+		inline const Demo::BoundingRect& GetBounds() const		{ return m_bounds; };
+
+	// Private state.
+	private:
+		Demo::BoundingRect	m_bounds;	// Bounds of grid.
+		size_t				m_columns;	// Count of cell columns.
+		size_t				m_rows;		// Count of cell rows.
+		Vector2f			m_scale;	// Scale to translate the offset from `m_bounds.min` into cell coordinates.
+	};
+}
+}
+}
@@ -1,5 +1,9 @@
 #include <demo/spatial/spatial.h>
 
+#include <atomic>
+#include <iterator>
+#include <thread>
+
 
 namespace Demo
 {
@@ -9,15 +13,10 @@ namespace Internal
 {
 namespace
 {
-	// Whether the quad is empty.
+	// Whether the quad is empty. Empty quad indexes no shapes in its whole subtree.
 	const bool IsEmpty( const Quad& quad )
 	{
-		if( !quad.shapes.empty() )
-		{
-			return false;
-		}
-
-		return quad.is_leaf || std::all_of( quad.quarters.begin(), quad.quarters.end(), []( const std::shared_ptr<Quad>& slot ) { return !slot; } );
+		return quad.shapes_count == 0;
 	}
 
 	// Get the index of quad quarter, where the given shape may be placed.
@@ -26,6 +25,14 @@ namespace
 		return quad.bounds.GetNearestCornerIndex( shape.GetBounds().GetCenter() );
 	}
 
+	// Whether the quad encloses the bounds with no shared edge. Tests of rects include the edges, so the bounds touching the border
+	// of quad may hit the shapes of neighbouring quads.
+	const bool IsStrictlyEnclosing( const Quad& quad, const Demo::BoundingRect& bounds )
+	{
+		return ( ( bounds.min.x > quad.bounds.min.x ) && ( bounds.min.y > quad.bounds.min.y ) )
+			&& ( ( bounds.max.x < quad.bounds.max.x ) && ( bounds.max.y < quad.bounds.max.y ) );
+	}
+
 	// Get the bounds of quad quarter by given index.
 	Demo::BoundingRect GetQuarterBounds( const Quad& quad, const size_t quarter_index )
 	{
@@ -39,148 +46,1416 @@ namespace
 		return { { corners[ min_x ].x, corners[ min_y ].y }, { corners[ max_x ].x, corners[ max_y ].y }, std::ignore };
 	}
 
-	// Remove the given shape from indexing.
-	void UnindexShape( Quad& quad, const Shape& shape )
+	// Pair of quads from the joined trees.
+	struct QuadPair final
 	{
-		auto found_slot = std::find( quad.shapes.begin(), quad.shapes.end(), &shape );
-		if( found_slot == quad.shapes.end() )
+		const Quad*	left;	// Quad of left tree.
+		const Quad*	right;	// Quad of right tree.
+	};
+
+
+	// Report each pair of intersecting shapes from the given shape and the subtree of quad.
+	// The shape is passed to the left if `IS_SHAPE_LEFT` is set.
+	template< bool IS_SHAPE_LEFT >
+	void JoinSubtree( const Shape& shape, const Quad& quad, const JoinCallback& callback )
+	{
+		const Demo::BoundingRect& bounds = shape.GetBounds();
+
+		std::pmr::vector<const Quad*> pending_quads{ { &quad }, GetQueryResource() };
+		while( !pending_quads.empty() )
 		{
-			for( auto& quarter : quad.quarters )
+			const Quad& pending_quad = *pending_quads.back();
+			pending_quads.pop_back();
+
+			for( const auto other_shape : pending_quad.shapes )
 			{
-				if( quarter && quarter->bounds.ConsistsOf( shape.GetBounds() ) )
+				if( !bounds.IsIntersects( other_shape->GetBounds() ) )
 				{
-					UnindexShape( *quarter, shape );
+					continue;
+				}
 
-					if( IsEmpty( *quarter ) )
-					{
-						quarter.reset();
-					}
+				if constexpr( IS_SHAPE_LEFT )
+				{
+					callback( shape, *other_shape );
+				}
+				else
+				{
+					callback( *other_shape, shape );
+				}
+			}
+
+			for( const auto& quarter : pending_quad.quarters )
+			{
+				if( quarter && bounds.IsIntersects( quarter->subtree_extent ) )
+				{
+					pending_quads.push_back( quarter.get() );
 				}
 			}
 		}
-		else
+	}
+
+	// Report the pairs of intersecting shapes, where at least one shape is indexed by the quad of pair itself.
+	// Pairs of intersecting quarters are gathered to be joined further.
+	template< typename TPairs >
+	void JoinPairLevel( const QuadPair& pair, const JoinCallback& callback, TPairs& child_pairs )
+	{
+		const auto [ left, right ] = pair;
+
+		for( const auto left_shape : left->shapes )
 		{
-			quad.shapes.erase( found_slot );
+			for( const auto right_shape : right->shapes )
+			{
+				if( left_shape->GetBounds().IsIntersects( right_shape->GetBounds() ) )
+				{
+					callback( *left_shape, *right_shape );
+				}
+			}
+
+			for( const auto& right_quarter : right->quarters )
+			{
+				if( right_quarter && left_shape->GetBounds().IsIntersects( right_quarter->subtree_extent ) )
+				{
+					JoinSubtree<true>( *left_shape, *right_quarter, callback );
+				}
+			}
+		}
+
+		for( const auto& left_quarter : left->quarters )
+		{
+			if( !left_quarter || !left_quarter->subtree_extent.IsIntersects( right->subtree_extent ) )
+			{
+				continue;
+			}
+
+			for( const auto right_shape : right->shapes )
+			{
+				if( right_shape->GetBounds().IsIntersects( left_quarter->subtree_extent ) )
+				{
+					JoinSubtree<false>( *right_shape, *left_quarter, callback );
+				}
+			}
+
+			for( const auto& right_quarter : right->quarters )
+			{
+				if( right_quarter && left_quarter->subtree_extent.IsIntersects( right_quarter->subtree_extent ) )
+				{
+					child_pairs.push_back( { left_quarter.get(), right_quarter.get() } );
+				}
+			}
 		}
 	}
-}
 
+	// Report each pair of intersecting shapes from the subtrees of quad pair.
+	void JoinPair( const QuadPair& pair, const JoinCallback& callback )
+	{
+		std::pmr::vector<QuadPair> pending_pairs{ { pair }, GetQueryResource() };
+		while( !pending_pairs.empty() )
+		{
+			const QuadPair pending_pair{ pending_pairs.back() };
+			pending_pairs.pop_back();
 
-	void IndexTree::Reset()
+			JoinPairLevel( pending_pair, callback, pending_pairs );
+		}
+	}
+
+	// Place the shape to the quad itself, along with its bounds.
+	void PlaceShape( Quad& quad, const Shape& shape )
 	{
-		m_root.reset();
+		quad.shapes.push_back( &shape );
+		quad.shapes_bounds.push_back( shape.GetBounds() );
+		quad.shapes_extent.Grow( shape.GetBounds() );
 	}
 
-	void IndexTree::Build( const Demo::BoundingRect& bounds )
+	// Remove the given shape from the quad itself. Returns whether the shape was found.
+	const bool EraseShape( Quad& quad, const Shape& shape )
+	{
+		auto found_slot = std::find( quad.shapes.begin(), quad.shapes.end(), &shape );
+		if( found_slot == quad.shapes.end() )
+		{
+			return false;
+		}
+
+		quad.shapes_bounds.erase( quad.shapes_bounds.begin() + std::distance( quad.shapes.begin(), found_slot ) );
+		quad.shapes.erase( found_slot );
+		return true;
+	}
+
+	// Remove the given shape from the pending shapes of quad. Returns whether the shape was found.
+	const bool ErasePendingShape( Quad& quad, const Shape& shape )
 	{
-		m_root = m_quad_provider.Create( bounds, 1 );
+		auto found_slot = std::find( quad.pending_shapes.begin(), quad.pending_shapes.end(), &shape );
+		if( found_slot == quad.pending_shapes.end() )
+		{
+			return false;
+		}
+
+		quad.pending_shapes.erase( found_slot );
+		return true;
+	}
 
-		auto shapes_end = m_shapes.end();
-		for( auto current = m_shapes.begin(); current != shapes_end; ++current )
+	// Count the quads in the whole subtree of quad.
+	const size_t GetQuadsCount( const Quad& quad )
+	{
+		size_t result = 1;
+		for( const auto& quarter : quad.quarters )
 		{
-			if( *current == nullptr )
+			if( quarter )
 			{
-				std::swap( *current, *( --shapes_end ) );
+				result += GetQuadsCount( *quarter );
 			}
+		}
+
+		return result;
+	}
+
+	// Copy the indexing state of refined quad to the relocated one. Arrays of shapes are copied to be allocated in order of relocation.
+	void CopyQuadState( const Quad& source, Quad& target )
+	{
+		target.shapes			= source.shapes;
+		target.shapes_bounds	= source.shapes_bounds;
+		target.shapes_count		= source.shapes_count;
+		target.shapes_area		= source.shapes_area;
+		target.categories		= source.categories;
+		target.epoch			= source.epoch;
+		target.max_shape_size	= source.max_shape_size;
+		target.shapes_extent	= source.shapes_extent;
+		target.subtree_extent	= source.subtree_extent;
+		target.is_leaf			= source.is_leaf;
+	}
+
+	// Request the quad and the bounds of its shapes to be loaded into cache, before the quad is visited.
+	void PrefetchQuad( const Quad& quad )
+	{
+	#if defined( DEMO_MATH_SSE2 )
+		_mm_prefetch( reinterpret_cast<const char*>( &quad ), _MM_HINT_T0 );
+		_mm_prefetch( reinterpret_cast<const char*>( quad.shapes_bounds.data() ), _MM_HINT_T0 );
+	#endif
+	}
 
-			ReindexShape( *m_root, *( *current ) );
+	// Get the union of categories of given shapes.
+	const uint64_t GetCategories( const Shapes& shapes )
+	{
+		uint64_t result = 0;
+		for( const auto shape : shapes )
+		{
+			result |= shape->GetCategories();
 		}
 
-		if( shapes_end == m_shapes.end() )
+		return result;
+	}
+
+	// Get the area of bounds.
+	const double GetArea( const Demo::BoundingRect& bounds )
+	{
+		const Vector2f size{ bounds.GetSize() };
+		return double( size.x ) * double( size.y );
+	}
+
+	// Get the total area of bounds of given shapes.
+	const double GetTotalArea( const Shapes& shapes )
+	{
+		double result = 0.0;
+		for( const auto shape : shapes )
 		{
-			return;
+			result += GetArea( shape->GetBounds() );
 		}
 
-		m_shapes.erase( shapes_end, m_shapes.end() );
+		return result;
 	}
 
-	void IndexTree::Push( const Shape& shape )
+	// Recalculate the extent of shapes for quad itself.
+	void RefreshShapesExtent( Quad& quad )
 	{
-		m_shapes.push_back( &shape );
-		if( m_root )
+		quad.shapes_extent = EMPTY_EXTENT;
+		for( const auto& shape_bounds : quad.shapes_bounds )
 		{
-			ReindexShape( *m_root, shape );
+			quad.shapes_extent.Grow( shape_bounds );
 		}
 	}
 
-	void IndexTree::Pop( const Shape& shape )
+	// Recalculate the extent of subtree for quad, using the extent of its own shapes and the extents of its quarters.
+	// Bounds of pending shapes are not stored, so the extent of subtree is kept for quad with pending shapes. It stays wider than tight.
+	void RefreshSubtreeExtent( Quad& quad )
 	{
-		*std::find( m_shapes.begin(), m_shapes.end(), &shape ) = nullptr;
+		if( !quad.pending_shapes.empty() )
+		{
+			return;
+		}
 
-		if( m_root )
+		quad.subtree_extent = quad.shapes_extent;
+		for( const auto& quarter : quad.quarters )
 		{
-			UnindexShape( *m_root, shape );
+			if( quarter )
+			{
+				quad.subtree_extent.Grow( quarter->subtree_extent );
+			}
 		}
 	}
 
-
-	std::vector<const Shape*> IndexTree::Find( const Demo::BoundingRect& bounds ) const
+	// Recalculate the union of categories for quad, using its own shapes and the unions of its quarters.
+	void RefreshCategories( Quad& quad )
 	{
-		std::vector<const Shape*> result;
+		quad.categories = GetCategories( quad.shapes ) | GetCategories( quad.pending_shapes );
+		for( const auto& quarter : quad.quarters )
+		{
+			if( quarter )
+			{
+				quad.categories |= quarter->categories;
+			}
+		}
+	}
 
-		std::queue<const Quad*> pending_quads;
-		pending_quads.push( m_root.get() );
-		while( !pending_quads.empty() )
+	// Visit each shape of quad itself, which intersects the given bounds. Shapes are tested in batches by their stored bounds.
+	// Visiting stops once the visitor returns `false`. Returns `false` if the visiting was stopped.
+	template< typename TVisitor >
+	const bool VisitIntersectingShapes( const Quad& quad, const Demo::BoundingRect& bounds, TVisitor&& visitor )
+	{
+		for( size_t offset = 0; offset < quad.shapes.size(); offset += MASK_WORD_BITS )
 		{
-			const Quad& quad = *pending_quads.front();
-			pending_quads.pop();
+			uint64_t mask = 0;
+			IntersectsMask( bounds, quad.shapes_bounds.data() + offset, std::min( MASK_WORD_BITS, quad.shapes.size() - offset ), &mask );
 
-			for( const auto shape : quad.shapes )
+			for( size_t index = offset; mask != 0; ++index, mask >>= 1 )
 			{
-				if( bounds.IsIntersects( shape->GetBounds() ) )
+				if( ( ( mask & 1 ) != 0 ) && !visitor( quad.shapes[ index ] ) )
 				{
-					result.push_back( shape );
+					return false;
 				}
 			}
+		}
 
-			for( const auto& quarter : quad.quarters )
+		return true;
+	}
+
+	// Account the shape in the aggregates of quad, which subtree indexes the shape.
+	void AccountShape( Quad& quad, const Shape& shape )
+	{
+		++quad.shapes_count;
+		quad.shapes_area += GetArea( shape.GetBounds() );
+		quad.categories |= shape.GetCategories();
+		quad.epoch = std::max( quad.epoch, shape.GetEpoch() );
+		quad.max_shape_size.Maximize( shape.GetBounds().GetSize() );
+		quad.subtree_extent.Grow( shape.GetBounds() );
+	}
+
+	// Get the level of bucket quads for the tree of given count of shapes.
+	const size_t GetBucketLevel( const size_t shapes_count )
+	{
+		size_t level = 1;
+		for( size_t buckets_count = 1; ( level < IndexTree::MAX_BUCKET_LEVEL ) && ( buckets_count * IndexTree::BUCKET_SHAPES < shapes_count ); buckets_count *= 4 )
+		{
+			++level;
+		}
+
+		return level;
+	}
+
+	// Remove the given shape from indexing. The shape is searched along the path of quarters, selected by the bounds it was indexed with.
+	// Counts, categories and extents of shapes are fixed by climbing the parent links, empty quarters are released on the way.
+	// Returns whether the shape was found in subtree of quad.
+	const bool UnindexShape( Quad& root, const Shape& shape, const Demo::BoundingRect& bounds )
+	{
+		Quad* quad = &root;
+		while( !EraseShape( *quad, shape ) && !ErasePendingShape( *quad, shape ) )
+		{
+			const auto& quarter = quad->quarters[ quad->bounds.GetNearestCornerIndex( bounds.GetCenter() ) ];
+			if( !quarter )
 			{
-				if( quarter && bounds.IsIntersects( quarter->bounds ) )
-				{
-					pending_quads.push( quarter.get() );
-				}
+				return false;
 			}
+
+			quad = quarter.get();
 		}
 
-		return result;
+		RefreshShapesExtent( *quad );
+		while( quad != nullptr )
+		{
+			Quad* const parent = quad->parent;
+
+			--quad->shapes_count;
+			quad->shapes_area = ( quad->shapes_count > 0 )? quad->shapes_area - GetArea( bounds ) : 0.0;
+			if( ( parent != nullptr ) && IsEmpty( *quad ) )
+			{
+				std::find_if( parent->quarters.begin(), parent->quarters.end(), [quad]( const auto& quarter ) { return quarter.get() == quad; } )->reset();
+			}
+			else
+			{
+				RefreshCategories( *quad );
+				RefreshSubtreeExtent( *quad );
+			}
+
+			quad = parent;
+		}
+
+		return true;
 	}
 
-	void IndexTree::ReindexShape( Quad& quad, const Shape& shape )
+	// Descend the frozen levels of tree, which lie above the entry level of concurrent updates, along the path of given bounds.
+	// Quarters of frozen levels stay in place during the concurrent updates, so no locks are taken.
+	// Returns the quad of entry level or the frozen quad, which quarters do not fit the bounds.
+	Quad& DescendFrozenLevels( Quad& root, const Demo::BoundingRect& bounds )
 	{
-		if( quad.is_leaf )
+		Quad* quad = &root;
+		while( quad->level < IndexTree::CONCURRENT_ENTRY_LEVEL )
 		{
-			if( ( quad.shapes.size() < MAX_POINTS ) || ( quad.level >= MAX_LEVELS ) )
+			const size_t quarter_index = quad->bounds.GetNearestCornerIndex( bounds.GetCenter() );
+			if( !GetQuarterBounds( *quad, quarter_index ).ConsistsOf( bounds ) )
+			{
+				break;
+			}
+
+			quad = quad->quarters[ quarter_index ].get();
+		}
+
+		return *quad;
+	}
+
+	// Remove the given shape from indexing, while other threads update the tree concurrently. Frozen levels are descended with no locks.
+	// Quads from the entry level down are locked one after another, the lock of quarter is taken before the lock of its parent is released.
+	// The shape is always indexed along the path of its bounds, so counts of shapes below the frozen levels are fixed on the way down.
+	// Aggregates of frozen quads, categories and extents of subtrees are recalculated and empty quarters are released by the tidying of tree.
+	void UnindexShapeConcurrently( Quad& root, const Shape& shape, const Demo::BoundingRect& bounds )
+	{
+		Quad* quad = &DescendFrozenLevels( root, bounds );
+		std::unique_lock<QuadLock> quad_lock{ quad->lock };
+		if( quad->level < IndexTree::CONCURRENT_ENTRY_LEVEL )
+		{
+			EraseShape( *quad, shape );
+			return;
+		}
+
+		while( quad != nullptr )
+		{
+			--quad->shapes_count;
+			quad->shapes_area = ( quad->shapes_count > 0 )? quad->shapes_area - GetArea( bounds ) : 0.0;
+			if( EraseShape( *quad, shape ) )
 			{
-				quad.shapes.push_back( &shape );
+				RefreshShapesExtent( *quad );
 				return;
 			}
 
-			SplitToQuarters( quad );
+			if( ErasePendingShape( *quad, shape ) )
+			{
+				return;
+			}
+
+			Quad* const quarter = quad->quarters[ quad->bounds.GetNearestCornerIndex( bounds.GetCenter() ) ].get();
+			if( quarter != nullptr )
+			{
+				std::unique_lock<QuadLock> quarter_lock{ quarter->lock };
+				quad_lock = std::move( quarter_lock );
+			}
+
+			quad = quarter;
 		}
+	}
 
-		const size_t quarter_index = GetQuarterIndex( quad, shape );
-		auto& quarter = quad.quarters[ quarter_index ];
+	// Recalculate the aggregates of quads in the whole subtree of quad, which are left stale or wider than tight by the concurrent updates.
+	// Empty quarters are released on the way.
+	void TidySubtree( Quad& quad )
+	{
+		quad.shapes_count	= 0;
+		quad.shapes_area	= 0.0;
+		quad.categories		= 0;
+		quad.epoch			= 0;
+		quad.max_shape_size	= { 0.0f, 0.0f };
+		quad.subtree_extent	= EMPTY_EXTENT;
+		for( const auto shape : quad.shapes )
+		{
+			AccountShape( quad, *shape );
+		}
 
-		const Demo::BoundingRect quarter_bounds{ GetQuarterBounds( quad, quarter_index ) };
-		if( quarter_bounds.ConsistsOf( shape.GetBounds() ) )
+		for( const auto shape : quad.pending_shapes )
+		{
+			AccountShape( quad, *shape );
+		}
+
+		RefreshShapesExtent( quad );
+
+		for( auto& quarter : quad.quarters )
 		{
 			if( !quarter )
 			{
-				quarter = m_quad_provider.Create( quarter_bounds, quad.level + 1 );
+				continue;
 			}
 
-			return ReindexShape( *quarter, shape );
+			TidySubtree( *quarter );
+			if( IsEmpty( *quarter ) )
+			{
+				quarter.reset();
+				continue;
+			}
+
+			quad.shapes_count	+= quarter->shapes_count;
+			quad.shapes_area	+= quarter->shapes_area;
+			quad.categories		|= quarter->categories;
+			quad.epoch			= std::max( quad.epoch, quarter->epoch );
+			quad.max_shape_size.Maximize( quarter->max_shape_size );
+			quad.subtree_extent.Grow( quarter->subtree_extent );
 		}
-		else
+	}
+}
+
+
+	void IndexTree::Reset()
+	{
+		m_root.reset();
+	}
+
+	void IndexTree::Build( const Demo::BoundingRect& bounds )
+	{
+		m_root = m_quad_provider.Create( bounds, 1, nullptr );
+
+		// Shapes are only placed to the bucket quads here. Distribution of them inside the buckets is delayed until the searching.
+		m_shapes.erase( std::remove( m_shapes.begin(), m_shapes.end(), nullptr ), m_shapes.end() );
+
+		const size_t bucket_level = GetBucketLevel( m_shapes.size() );
+		for( const auto shape : m_shapes )
+		{
+			BucketShape( *shape, bucket_level );
+		}
+	}
+
+	void IndexTree::Push( const Shape& shape )
+	{
+		if( m_is_concurrent_updates )
+		{
+			UpdateStage& stage = m_update_stages[ GetThreadShardIndex() ];
+			{
+				std::lock_guard<std::mutex> lock{ stage.mutex };
+				stage.pushed_shapes.push_back( &shape );
+			}
+
+			if( m_root )
+			{
+				ReindexShapeConcurrently( shape );
+			}
+
+			return;
+		}
+
+		m_shapes.push_back( &shape );
+		if( m_root )
+		{
+			ReindexShape( *m_root, shape );
+		}
+	}
+
+	void IndexTree::Pop( const Shape& shape )
+	{
+		// Concurrently popped shapes are removed from the collection at once, when the concurrent updates are disabled.
+		if( m_is_concurrent_updates )
 		{
-			quad.shapes.push_back( &shape );
+			UpdateStage& stage = m_update_stages[ GetThreadShardIndex() ];
+			{
+				std::lock_guard<std::mutex> lock{ stage.mutex };
+				stage.popped_shapes.push_back( &shape );
+			}
+
+			if( m_root )
+			{
+				UnindexShapeConcurrently( *m_root, shape, shape.GetBounds() );
+			}
+
 			return;
 		}
+
+		*std::find( m_shapes.begin(), m_shapes.end(), &shape ) = nullptr;
+
+		if( m_root )
+		{
+			UnindexShape( *m_root, shape, shape.GetBounds() );
+		}
 	}
 
-	void IndexTree::SplitToQuarters( Quad& quad )
+	void IndexTree::Move( const Shape& shape, const Demo::BoundingRect& previous_bounds )
 	{
-		quad.is_leaf = false;
+		if( m_root )
+		{
+			UnindexShape( *m_root, shape, previous_bounds );
+			ReindexShape( *m_root, shape );
+		}
+	}
+
+
+	QueryResult IndexTree::Find( const Demo::BoundingRect& bounds )
+	{
+		return FindInArea( bounds, *m_root, {} );
+	}
+
+	QueryResult IndexTree::Find( const Demo::BoundingRect& bounds, QueryHint& hint )
+	{
+		Quad* top_quad = m_root.get();
+		if( const auto hinted_quad = ( hint.m_tree == this )? hint.m_quad.lock() : nullptr )
+		{
+			top_quad = hinted_quad.get();
+		}
+
+		// Climb up until the quad strictly encloses the bounds, then descend to the deepest quad strictly enclosing the bounds.
+		// Bounds touching the edge of quad may hit the shapes of its siblings, so such a quad can not be the top one.
+		while( ( top_quad->parent != nullptr ) && !IsStrictlyEnclosing( *top_quad, bounds ) )
+		{
+			top_quad = top_quad->parent;
+		}
+
+		while( IsStrictlyEnclosing( *top_quad, bounds ) )
+		{
+			RefineQuad( *top_quad );
+
+			const auto& quarter = top_quad->quarters[ top_quad->bounds.GetNearestCornerIndex( bounds.GetCenter() ) ];
+			if( !quarter || !IsStrictlyEnclosing( *quarter, bounds ) )
+			{
+				break;
+			}
+
+			top_quad = quarter.get();
+		}
+
+		hint.m_tree	= this;
+		hint.m_quad	= GetSharedQuad( *top_quad );
+
+		QueryResult result{ FindInArea( bounds, *top_quad, {} ) };
+
+		// Shapes of ancestors are not bound by the subtree of top quad, so they are tested separately.
+		for( const Quad* quad = top_quad->parent; quad != nullptr; quad = quad->parent )
+		{
+			for( const auto shape : quad->shapes )
+			{
+				if( bounds.IsIntersects( shape->GetBounds() ) )
+				{
+					result.push_back( shape );
+				}
+			}
+		}
+
+		return result;
+	}
+
+	QueryResult IndexTree::Find( const Demo::BoundingRect& bounds, const uint64_t categories )
+	{
+		return FindInArea( bounds, *m_root, { categories, 0 } );
+	}
+
+	QueryResult IndexTree::FindChangedSince( const Demo::BoundingRect& bounds, const uint64_t epoch )
+	{
+		return FindInArea( bounds, *m_root, { Shape::ALL_CATEGORIES, epoch } );
+	}
+
+	QueryResult IndexTree::Find( const ConvexPolygon& polygon )
+	{
+		return FindInArea( polygon, *m_root, {} );
+	}
+
+	SweepResult IndexTree::FindSwept( const Demo::BoundingRect& bounds, const Vector2f& displacement, const bool is_first_hit_only )
+	{
+		if( is_first_hit_only )
+		{
+			return FindFirstHit( bounds, displacement );
+		}
+
+		SweepResult result{ GetQueryResource() };
+		if( std::isinf( bounds.GetSweepTime( m_root->bounds, displacement ) ) )
+		{
+			return result;
+		}
+
+		std::pmr::vector<Quad*> pending_quads{ { m_root.get() }, GetQueryResource() };
+		while( !pending_quads.empty() )
+		{
+			Quad& quad = *pending_quads.back();
+			pending_quads.pop_back();
+
+			RefineQuad( quad );
+			for( const auto shape : quad.shapes )
+			{
+				const float time = bounds.GetSweepTime( shape->GetBounds(), displacement );
+				if( !std::isinf( time ) )
+				{
+					result.push_back( { shape, time } );
+				}
+			}
+
+			for( const auto& quarter : quad.quarters )
+			{
+				if( quarter && !std::isinf( bounds.GetSweepTime( quarter->bounds, displacement ) ) )
+				{
+					pending_quads.push_back( quarter.get() );
+				}
+			}
+		}
+
+		OrderHits( result );
+		return result;
+	}
+
+	void IndexTree::Join( IndexTree& other, const JoinCallback& callback, const size_t threads_count )
+	{
+		if( !m_root->bounds.IsIntersects( other.m_root->bounds ) )
+		{
+			return;
+		}
+
+		// Joining visits the most of both trees, so the trees are refined at once. It also keeps the trees immutable for threads.
+		RefineSubtree( *m_root );
+		other.RefineSubtree( *other.m_root );
+
+		// Count of pairs per thread to be gathered before the concurrent joining. It smooths the imbalance of subtrees.
+		constexpr size_t PAIRS_PER_THREAD = 8;
+
+		if( threads_count < 2 )
+		{
+			JoinPair( { m_root.get(), other.m_root.get() }, callback );
+			return;
+		}
+
+		// Upper levels of trees are joined here, until there are enough pairs of subtrees to share between threads.
+		std::vector<QuadPair> pairs{ { m_root.get(), other.m_root.get() } };
+		while( !pairs.empty() && ( pairs.size() < threads_count * PAIRS_PER_THREAD ) )
+		{
+			std::vector<QuadPair> child_pairs;
+			for( const auto& pair : pairs )
+			{
+				JoinPairLevel( pair, callback, child_pairs );
+			}
+
+			pairs.swap( child_pairs );
+		}
+
+		std::atomic<size_t> next_pair_index{ 0 };
+		auto join_pairs = [&pairs, &next_pair_index, &callback]()
+		{
+			for( size_t pair_index = next_pair_index++; pair_index < pairs.size(); pair_index = next_pair_index++ )
+			{
+				JoinPair( pairs[ pair_index ], callback );
+			}
+		};
+
+		std::vector<std::thread> threads;
+		threads.reserve( threads_count - 1 );
+		for( size_t thread_index = 1; thread_index < threads_count; ++thread_index )
+		{
+			threads.emplace_back( join_pairs );
+		}
+
+		join_pairs();
+		for( auto& thread : threads )
+		{
+			thread.join();
+		}
+	}
+
+	void IndexTree::Optimize()
+	{
+		if( !m_root )
+		{
+			return;
+		}
+
+		RefineSubtree( *m_root );
+		m_quad_provider.Reserve( GetQuadsCount( *m_root ) );
+
+		std::shared_ptr<Quad> root{ m_quad_provider.Create( m_root->bounds, m_root->level, nullptr ) };
+		CopyQuadState( *m_root, *root );
+		RelocateQuarters( *m_root, *root );
+
+		m_root = std::move( root );
+	}
+
+	void IndexTree::SetConcurrentUpdates( const bool is_enabled )
+	{
+		if( m_is_concurrent_updates == is_enabled )
+		{
+			return;
+		}
+
+		m_is_concurrent_updates = is_enabled;
+		if( m_is_concurrent_updates )
+		{
+			if( m_root )
+			{
+				FreezeSubtree( *m_root );
+			}
+
+			return;
+		}
+
+		// Shape may be pushed by one thread and popped by another, so the stages are merged before the popped shapes are removed.
+		Shapes released_shapes;
+		for( auto& stage : m_update_stages )
+		{
+			m_shapes.insert( m_shapes.end(), stage.pushed_shapes.begin(), stage.pushed_shapes.end() );
+			released_shapes.insert( released_shapes.end(), stage.popped_shapes.begin(), stage.popped_shapes.end() );
+			stage.pushed_shapes.clear();
+			stage.popped_shapes.clear();
+		}
+
+		// Slot of released shape may be taken by the shape acquired later, so the collection may hold the same pointer twice.
+		// Difference of sorted collections removes just one entry for each released shape.
+		if( !released_shapes.empty() )
+		{
+			std::sort( m_shapes.begin(), m_shapes.end() );
+			std::sort( released_shapes.begin(), released_shapes.end() );
+
+			Shapes alive_shapes;
+			alive_shapes.reserve( m_shapes.size() );
+			std::set_difference( m_shapes.begin(), m_shapes.end(), released_shapes.begin(), released_shapes.end(), std::back_inserter( alive_shapes ) );
+
+			m_shapes.swap( alive_shapes );
+		}
+
+		if( m_root )
+		{
+			TidySubtree( *m_root );
+		}
+	}
+
+	const bool IndexTree::Any( const Demo::BoundingRect& bounds )
+	{
+		if( !bounds.IsIntersects( m_root->bounds ) )
+		{
+			return false;
+		}
+
+		std::pmr::vector<Quad*> pending_quads{ { m_root.get() }, GetQueryResource() };
+		while( !pending_quads.empty() )
+		{
+			Quad& quad = *pending_quads.back();
+			pending_quads.pop_back();
+
+			if( bounds.ConsistsOf( quad.subtree_extent ) && ( quad.shapes_count > 0 ) )
+			{
+				return true;
+			}
+
+			RefineQuad( quad );
+			if( bounds.IsIntersects( quad.shapes_extent ) && !VisitIntersectingShapes( quad, bounds, []( const Shape* ) { return false; } ) )
+			{
+				return true;
+			}
+
+			for( const auto& quarter : quad.quarters )
+			{
+				if( quarter && bounds.IsIntersects( quarter->subtree_extent ) )
+				{
+					pending_quads.push_back( quarter.get() );
+				}
+			}
+		}
+
+		return false;
+	}
+
+	const size_t IndexTree::Count( const Demo::BoundingRect& bounds )
+	{
+		if( !bounds.IsIntersects( m_root->bounds ) )
+		{
+			return 0;
+		}
+
+		size_t result = 0;
+
+		std::pmr::vector<Quad*> pending_quads{ { m_root.get() }, GetQueryResource() };
+		while( !pending_quads.empty() )
+		{
+			Quad& quad = *pending_quads.back();
+			pending_quads.pop_back();
+
+			// The whole subtree of quad, which shapes lie inside the bounds, is counted at once.
+			if( bounds.ConsistsOf( quad.subtree_extent ) )
+			{
+				result += quad.shapes_count;
+				continue;
+			}
+
+			RefineQuad( quad );
+			if( bounds.IsIntersects( quad.shapes_extent ) )
+			{
+				VisitIntersectingShapes( quad, bounds, [&result]( const Shape* ) { ++result; return true; } );
+			}
+
+			for( const auto& quarter : quad.quarters )
+			{
+				if( quarter && bounds.IsIntersects( quarter->subtree_extent ) )
+				{
+					pending_quads.push_back( quarter.get() );
+				}
+			}
+		}
+
+		return result;
+	}
+
+	HistogramResult IndexTree::Histogram( const Demo::BoundingRect& bounds, const size_t columns, const size_t rows )
+	{
+		HistogramResult result{ columns * rows, HistogramCell{}, GetQueryResource() };
+		if( result.empty() || !bounds.IsIntersects( m_root->bounds ) )
+		{
+			return result;
+		}
+
+		const HistogramGrid grid{ bounds, columns, rows };
+		auto account_shape = [&result, &grid]( const Demo::BoundingRect& shape_bounds )
+		{
+			const Vector2f center{ shape_bounds.GetCenter() };
+			if( grid.GetBounds().ConsistsOf( center ) )
+			{
+				HistogramCell& cell = result[ grid.GetCellIndex( center ) ];
+				++cell.shapes_count;
+				cell.shapes_area += GetArea( shape_bounds );
+			}
+		};
+
+		std::pmr::vector<Quad*> pending_quads{ { m_root.get() }, GetQueryResource() };
+		while( !pending_quads.empty() )
+		{
+			Quad& quad = *pending_quads.back();
+			pending_quads.pop_back();
+
+			// Centers of all the shapes of subtree lie inside the quad. So the subtree inside single cell is accounted at once.
+			// Quads usually end exactly on the borders of cells, so the maximum corner is taken just inside the quad.
+			const Vector2f inner_max{ std::nextafter( quad.bounds.max.x, quad.bounds.min.x ), std::nextafter( quad.bounds.max.y, quad.bounds.min.y ) };
+			if( bounds.ConsistsOf( quad.bounds ) && ( grid.GetCellIndex( quad.bounds.min ) == grid.GetCellIndex( inner_max ) ) )
+			{
+				HistogramCell& cell = result[ grid.GetCellIndex( quad.bounds.min ) ];
+				cell.shapes_count	+= quad.shapes_count;
+				cell.shapes_area	+= quad.shapes_area;
+				continue;
+			}
+
+			RefineQuad( quad );
+			for( const auto& shape_bounds : quad.shapes_bounds )
+			{
+				account_shape( shape_bounds );
+			}
+
+			for( const auto& quarter : quad.quarters )
+			{
+				if( quarter && bounds.IsIntersects( quarter->subtree_extent ) )
+				{
+					pending_quads.push_back( quarter.get() );
+				}
+			}
+		}
+
+		return result;
+	}
+
+	QueryResult IndexTree::FindTop( const Demo::BoundingRect& bounds, const size_t count, const SizeKey key, const size_t visits_budget )
+	{
+		TopShapes top_shapes{ count, key };
+
+		// Quad to be visited, along with the upper limit of sizes of its shapes.
+		struct PendingQuad final
+		{
+			Quad*	quad;
+			float	size_limit;
+		};
+
+		// The quad with the largest limit of sizes is placed at the top of heap.
+		constexpr auto is_smaller = []( const PendingQuad& left, const PendingQuad& right ) { return left.size_limit < right.size_limit; };
+
+		// Shapes of subtree are limited both by the sizes of indexed shapes and by the bounds of quad itself.
+		auto get_size_limit = [&top_shapes]( const Quad& quad )
+		{
+			return top_shapes.Measure( quad.subtree_extent.GetSize().Minimized( quad.max_shape_size ) );
+		};
+
+		if( ( count == 0 ) || !bounds.IsIntersects( m_root->subtree_extent ) )
+		{
+			return top_shapes.TakeResult();
+		}
+
+		size_t visits_count = 0;
+		std::pmr::vector<PendingQuad> pending_quads{ { { m_root.get(), get_size_limit( *m_root ) } }, GetQueryResource() };
+		while( !pending_quads.empty() && ( visits_count < visits_budget ) )
+		{
+			std::pop_heap( pending_quads.begin(), pending_quads.end(), is_smaller );
+			const auto [ quad, size_limit ] = pending_quads.back();
+			pending_quads.pop_back();
+
+			// No shape in the rest of quads may be larger than the found ones.
+			if( top_shapes.IsSaturated( size_limit ) )
+			{
+				break;
+			}
+
+			++visits_count;
+			RefineQuad( *quad );
+			if( bounds.IsIntersects( quad->shapes_extent ) )
+			{
+				VisitIntersectingShapes( *quad, bounds, [&top_shapes]( const Shape* shape ) { top_shapes.Push( *shape ); return true; } );
+			}
+
+			for( const auto& quarter : quad->quarters )
+			{
+				if( !quarter || !bounds.IsIntersects( quarter->subtree_extent ) )
+				{
+					continue;
+				}
+
+				const float quarter_size_limit = get_size_limit( *quarter );
+				if( !top_shapes.IsSaturated( quarter_size_limit ) )
+				{
+					pending_quads.push_back( { quarter.get(), quarter_size_limit } );
+					std::push_heap( pending_quads.begin(), pending_quads.end(), is_smaller );
+				}
+			}
+		}
+
+		return top_shapes.TakeResult();
+	}
+
+	SweepResult IndexTree::FindFirstHit( const Demo::BoundingRect& bounds, const Vector2f& displacement )
+	{
+		SweepResult result{ GetQueryResource() };
+
+		// Quad to be visited, along with its time of impact.
+		struct PendingQuad final
+		{
+			Quad*	quad;
+			float	time;
+		};
+
+		// The quad with the earliest time of impact is placed at the top of heap.
+		constexpr auto is_later = []( const PendingQuad& left, const PendingQuad& right ) { return left.time > right.time; };
+
+		const float root_time = bounds.GetSweepTime( m_root->bounds, displacement );
+		if( std::isinf( root_time ) )
+		{
+			return result;
+		}
+
+		SweepHit first_hit{ nullptr, std::numeric_limits<float>::infinity() };
+
+		std::pmr::vector<PendingQuad> pending_quads{ { { m_root.get(), root_time } }, GetQueryResource() };
+		while( !pending_quads.empty() )
+		{
+			std::pop_heap( pending_quads.begin(), pending_quads.end(), is_later );
+			const auto [ quad, quad_time ] = pending_quads.back();
+			pending_quads.pop_back();
+
+			// No shape in the rest of quads may be hit earlier than the found one.
+			if( quad_time > first_hit.time )
+			{
+				break;
+			}
+
+			RefineQuad( *quad );
+			for( const auto shape : quad->shapes )
+			{
+				const float time = bounds.GetSweepTime( shape->GetBounds(), displacement );
+				if( time < first_hit.time )
+				{
+					first_hit = { shape, time };
+				}
+			}
+
+			for( const auto& quarter : quad->quarters )
+			{
+				if( !quarter )
+				{
+					continue;
+				}
+
+				const float time = bounds.GetSweepTime( quarter->bounds, displacement );
+				if( time < first_hit.time )
+				{
+					pending_quads.push_back( { quarter.get(), time } );
+					std::push_heap( pending_quads.begin(), pending_quads.end(), is_later );
+				}
+			}
+		}
+
+		if( first_hit.shape != nullptr )
+		{
+			result.push_back( first_hit );
+		}
+
+		return result;
+	}
+
+	template< typename TArea >
+	QueryResult IndexTree::FindInArea( const TArea& area, Quad& top_quad, const ShapeFilter& filter )
+	{
+		QueryResult result{ GetQueryResource() };
+
+		// Shapes of any categories are searched with no tests of categories, so the shapes with no categories are found too.
+		const bool is_category_filtered = filter.categories != Shape::ALL_CATEGORIES;
+		auto is_matching = [is_category_filtered, &filter]( const Shape* shape )
+		{
+			return ( !is_category_filtered || ( ( shape->GetCategories() & filter.categories ) != 0 ) ) && ( shape->GetEpoch() >= filter.epoch );
+		};
+
+		auto is_pruned = [is_category_filtered, &filter]( const Quad& quad )
+		{
+			return ( is_category_filtered && ( ( quad.categories & filter.categories ) == 0 ) ) || ( quad.epoch < filter.epoch );
+		};
+		auto push_matching = [&result, &is_matching]( const Shapes& shapes )
+		{
+			std::copy_if( shapes.begin(), shapes.end(), std::back_inserter( result ), is_matching );
+		};
+
+		// Quad to be visited, along with its classification against the area.
+		struct PendingQuad final
+		{
+			Quad*	quad;
+			bool	is_inside;
+		};
+
+		if( top_quad.shapes_count == 0 )
+		{
+			return result;
+		}
+
+		const Containment top_containment = area.Classify( top_quad.subtree_extent );
+		if( ( top_containment == Containment::Outside ) || is_pruned( top_quad ) )
+		{
+			return result;
+		}
+
+		// Quads are visited in order of queuing, the visited ones are just skipped by the index.
+		std::pmr::vector<PendingQuad> pending_quads{ { { &top_quad, top_containment == Containment::Inside } }, GetQueryResource() };
+		for( size_t quad_index = 0; quad_index < pending_quads.size(); ++quad_index )
+		{
+			const auto [ quad, is_inside ] = pending_quads[ quad_index ];
+
+			// The whole subtree of quad, which lies inside the area, is gathered with no tests and with no refinement.
+			if( is_inside )
+			{
+				push_matching( quad->shapes );
+				push_matching( quad->pending_shapes );
+			}
+			else
+			{
+				RefineQuad( *quad );
+
+				// Shapes of quad itself are tested only if their tight bounds reach the area.
+				if( !quad->shapes.empty() && area.IsIntersects( quad->shapes_extent ) )
+				{
+					if constexpr( std::is_same_v<TArea, Demo::BoundingRect> )
+					{
+						VisitIntersectingShapes(
+							*quad,
+							area,
+							[&result, &is_matching]( const Shape* shape )
+							{
+								if( is_matching( shape ) )
+								{
+									result.push_back( shape );
+								}
+
+								return true;
+							}
+						);
+					}
+					else
+					{
+						for( const auto shape : quad->shapes )
+						{
+							if( is_matching( shape ) && area.IsIntersects( shape->GetBounds() ) )
+							{
+								result.push_back( shape );
+							}
+						}
+					}
+				}
+			}
+
+			for( const auto& quarter : quad->quarters )
+			{
+				if( !quarter || is_pruned( *quarter ) )
+				{
+					continue;
+				}
+
+				const Containment quarter_containment = is_inside? Containment::Inside : area.Classify( quarter->subtree_extent );
+				if( quarter_containment != Containment::Outside )
+				{
+					PrefetchQuad( *quarter );
+					pending_quads.push_back( { quarter.get(), quarter_containment == Containment::Inside } );
+				}
+			}
+		}
+
+		return result;
+	}
+
+	std::shared_ptr<Quad> IndexTree::GetSharedQuad( Quad& quad ) const
+	{
+		if( quad.parent == nullptr )
+		{
+			return m_root;
+		}
+
+		const auto& quarters = quad.parent->quarters;
+		return *std::find_if( quarters.begin(), quarters.end(), [&quad]( const auto& quarter ) { return quarter.get() == &quad; } );
+	}
+
+	void IndexTree::RefineQuad( Quad& quad )
+	{
+		if( quad.pending_shapes.empty() )
+		{
+			return;
+		}
+
+		Shapes pending_shapes{ std::exchange( quad.pending_shapes, {} ) };
+		if( quad.is_leaf )
+		{
+			if( ( quad.shapes.size() + pending_shapes.size() <= MAX_POINTS ) || ( quad.level >= MAX_LEVELS ) )
+			{
+				for( const auto shape : pending_shapes )
+				{
+					PlaceShape( quad, *shape );
+				}
+
+				return;
+			}
+
+			// Shapes of leaf are distributed along with the pending ones.
+			quad.is_leaf = false;
+			pending_shapes.insert( pending_shapes.end(), quad.shapes.begin(), quad.shapes.end() );
+			quad.shapes.clear();
+			quad.shapes_bounds.clear();
+			quad.shapes_extent = EMPTY_EXTENT;
+		}
+
+		// Bounds of pending shapes are gathered once, then the centers and the fitting into quarters are found in batches.
+		const size_t pending_count = pending_shapes.size();
+		const size_t mask_words_count = GetMaskWordsCount( pending_count );
+
+		ShapesBounds pending_bounds( pending_count );
+		std::transform( pending_shapes.begin(), pending_shapes.end(), pending_bounds.begin(), []( const Shape* shape ) { return shape->GetBounds(); } );
+
+		std::vector<Vector2f> pending_centers( pending_count );
+		CentersOf( pending_bounds.data(), pending_count, pending_centers.data() );
+
+		std::array<Demo::BoundingRect, Demo::BoundingRect::CORNERS_COUNT> quarters_bounds;
+		std::vector<uint64_t> fitting_masks( quarters_bounds.size() * mask_words_count );
+		for( size_t quarter_index = 0; quarter_index < quarters_bounds.size(); ++quarter_index )
+		{
+			quarters_bounds[ quarter_index ] = GetQuarterBounds( quad, quarter_index );
+			ContainsMask( quarters_bounds[ quarter_index ], pending_bounds.data(), pending_count, fitting_masks.data() + quarter_index * mask_words_count );
+		}
+
+		for( size_t index = 0; index < pending_count; ++index )
+		{
+			const size_t quarter_index	= quad.bounds.GetNearestCornerIndex( pending_centers[ index ] );
+			const uint64_t fitting_word	= fitting_masks[ quarter_index * mask_words_count + index / MASK_WORD_BITS ];
+			if( ( ( fitting_word >> ( index % MASK_WORD_BITS ) ) & 1 ) == 0 )
+			{
+				quad.shapes.push_back( pending_shapes[ index ] );
+				quad.shapes_bounds.push_back( pending_bounds[ index ] );
+				quad.shapes_extent.Grow( pending_bounds[ index ] );
+				continue;
+			}
+
+			auto& quarter = quad.quarters[ quarter_index ];
+			if( !quarter )
+			{
+				quarter = m_quad_provider.Create( quarters_bounds[ quarter_index ], quad.level + 1, &quad );
+			}
+
+			quarter->pending_shapes.push_back( pending_shapes[ index ] );
+			quarter->categories |= pending_shapes[ index ]->GetCategories();
+			quarter->epoch = std::max( quarter->epoch, pending_shapes[ index ]->GetEpoch() );
+			++quarter->shapes_count;
+			quarter->shapes_area += GetArea( pending_bounds[ index ] );
+			quarter->max_shape_size.Maximize( pending_bounds[ index ].GetSize() );
+			quarter->subtree_extent.Grow( pending_bounds[ index ] );
+		}
+	}
+
+	void IndexTree::RefineSubtree( Quad& quad )
+	{
+		RefineQuad( quad );
+		for( const auto& quarter : quad.quarters )
+		{
+			if( quarter )
+			{
+				RefineSubtree( *quarter );
+			}
+		}
+	}
+
+	void IndexTree::BucketShape( const Shape& shape, const size_t bucket_level )
+	{
+		Quad* quad = m_root.get();
+		while( quad->level < bucket_level )
+		{
+			AccountShape( *quad, shape );
+			quad->is_leaf = false;
+
+			const size_t quarter_index = GetQuarterIndex( *quad, shape );
+			const Demo::BoundingRect quarter_bounds{ GetQuarterBounds( *quad, quarter_index ) };
+			if( !quarter_bounds.ConsistsOf( shape.GetBounds() ) )
+			{
+				PlaceShape( *quad, shape );
+				return;
+			}
+
+			auto& quarter = quad->quarters[ quarter_index ];
+			if( !quarter )
+			{
+				quarter = m_quad_provider.Create( quarter_bounds, quad->level + 1, quad );
+			}
+
+			quad = quarter.get();
+		}
+
+		AccountShape( *quad, shape );
+		quad->pending_shapes.push_back( &shape );
+	}
+
+	void IndexTree::FreezeSubtree( Quad& quad )
+	{
+		if( quad.level >= CONCURRENT_ENTRY_LEVEL )
+		{
+			return;
+		}
+
+		// Frozen quad keeps only the shapes, which do not fit its quarters, so the concurrent updates find them by geometry alone.
+		RefineQuad( quad );
+		if( quad.is_leaf )
+		{
+			SplitToQuarters( quad );
+		}
+
+		for( size_t quarter_index = 0; quarter_index < quad.quarters.size(); ++quarter_index )
+		{
+			auto& quarter = quad.quarters[ quarter_index ];
+			if( !quarter )
+			{
+				quarter = m_quad_provider.Create( GetQuarterBounds( quad, quarter_index ), quad.level + 1, &quad );
+			}
+
+			FreezeSubtree( *quarter );
+		}
+	}
+
+	void IndexTree::RelocateQuarters( const Quad& source, Quad& target )
+	{
+		for( size_t quarter_index = 0; quarter_index < source.quarters.size(); ++quarter_index )
+		{
+			if( const auto& quarter = source.quarters[ quarter_index ] )
+			{
+				target.quarters[ quarter_index ] = m_quad_provider.Create( quarter->bounds, quarter->level, &target );
+				CopyQuadState( *quarter, *target.quarters[ quarter_index ] );
+			}
+		}
+
+		for( size_t quarter_index = 0; quarter_index < source.quarters.size(); ++quarter_index )
+		{
+			if( const auto& quarter = source.quarters[ quarter_index ] )
+			{
+				RelocateQuarters( *quarter, *target.quarters[ quarter_index ] );
+			}
+		}
+	}
+
+	void IndexTree::ReindexShape( Quad& quad, const Shape& shape )
+	{
+		AccountShape( quad, shape );
+
+		// Quad, which is not refined yet, just keeps the shape pending.
+		if( !quad.pending_shapes.empty() )
+		{
+			quad.pending_shapes.push_back( &shape );
+			return;
+		}
+
+		if( quad.is_leaf )
+		{
+			if( ( quad.shapes.size() < MAX_POINTS ) || ( quad.level >= MAX_LEVELS ) )
+			{
+				PlaceShape( quad, shape );
+				return;
+			}
+
+			SplitToQuarters( quad );
+		}
+
+		const size_t quarter_index = GetQuarterIndex( quad, shape );
+		auto& quarter = quad.quarters[ quarter_index ];
+
+		const Demo::BoundingRect quarter_bounds{ GetQuarterBounds( quad, quarter_index ) };
+		if( quarter_bounds.ConsistsOf( shape.GetBounds() ) )
+		{
+			if( !quarter )
+			{
+				quarter = m_quad_provider.Create( quarter_bounds, quad.level + 1, &quad );
+			}
+
+			return ReindexShape( *quarter, shape );
+		}
+		else
+		{
+			PlaceShape( quad, shape );
+			return;
+		}
+	}
+
+	void IndexTree::ReindexShapeConcurrently( const Shape& shape )
+	{
+		Quad* quad = &DescendFrozenLevels( *m_root, shape.GetBounds() );
+		std::unique_lock<QuadLock> quad_lock{ quad->lock };
+		if( quad->level < CONCURRENT_ENTRY_LEVEL )
+		{
+			// Aggregates of frozen quad are recalculated once the concurrent updates are disabled.
+			PlaceShape( *quad, shape );
+			return;
+		}
+
+		while( true )
+		{
+			AccountShape( *quad, shape );
+			if( !quad->pending_shapes.empty() )
+			{
+				quad->pending_shapes.push_back( &shape );
+				return;
+			}
+
+			if( quad->is_leaf )
+			{
+				if( ( quad->shapes.size() < MAX_POINTS ) || ( quad->level >= MAX_LEVELS ) )
+				{
+					PlaceShape( *quad, shape );
+					return;
+				}
+
+				// New quarters are reachable only through the locked quad, so the splitting needs no other locks.
+				SplitToQuarters( *quad );
+			}
+
+			const size_t quarter_index = GetQuarterIndex( *quad, shape );
+			const Demo::BoundingRect quarter_bounds{ GetQuarterBounds( *quad, quarter_index ) };
+			if( !quarter_bounds.ConsistsOf( shape.GetBounds() ) )
+			{
+				PlaceShape( *quad, shape );
+				return;
+			}
+
+			auto& quarter = quad->quarters[ quarter_index ];
+			if( !quarter )
+			{
+				quarter = m_quad_provider.Create( quarter_bounds, quad->level + 1, quad );
+			}
+
+			// Lock of quarter is taken before the lock of quad is released, so no other update overtakes this one on the path.
+			std::unique_lock<QuadLock> quarter_lock{ quarter->lock };
+			quad_lock	= std::move( quarter_lock );
+			quad		= quarter.get();
+		}
+	}
+
+	void IndexTree::SplitToQuarters( Quad& quad )
+	{
+		quad.is_leaf = false;
+
+		// Shapes are counted again while re-indexing.
+		quad.shapes_count -= quad.shapes.size();
+		quad.shapes_area -= GetTotalArea( quad.shapes );
+		quad.shapes_bounds.clear();
+		quad.shapes_extent = EMPTY_EXTENT;
 		for( const auto shape : Shapes{ std::move( quad.shapes ) } )
 		{
 			ReindexShape( quad, *shape );
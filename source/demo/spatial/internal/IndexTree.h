@@ -13,6 +13,19 @@ namespace Internal
 		This type directly implements the `Quadtree` functionality. It only manage the quads and builds the tree for spatial searching.
 		The managing of tree state should be made externally. This tree does not rebuild or reset itself.
 		It always relies on external correctness of spatial bounds.
+
+		The tree is built lazily. The building only places each shape to the bucket quad, which encloses the shape, in a single pass.
+		Bucket quads lie at the level, where about `BUCKET_SHAPES` shapes are expected per bucket, limited by `MAX_BUCKET_LEVEL`.
+		Shapes, which cross the quarters of upper quads, are placed to those quads at once. Each bucket quad distributes its pending shapes
+		only once the searching descends into it, so the first searching refines only the buckets it touches.
+
+		While the concurrent updates are enabled, shapes may be pushed and popped by several threads at once. Enabling splits the quads
+		above `CONCURRENT_ENTRY_LEVEL` and creates all their quarters, so these levels are descended with no locks and no aggregates updated.
+		Upper quad is locked only to keep or to drop the shape, which does not fit its quarters. Quads from the entry level down are locked
+		one after another, so the updates of disjoint subtrees proceed in parallel. Quad is split to quarters under its own lock.
+		Each thread stages the pushed and popped shapes in its own list, which are merged into the collection of shapes once the concurrent
+		updates are disabled. Then the aggregates of quads are recalculated and the empty quarters are released.
+		No other operation is allowed during the concurrent updates.
 	*/
 	class IndexTree final
 	{
@@ -24,6 +37,15 @@ namespace Internal
 		// Maximum level of quad tree depth before the quarters splitting will be stopped.
 		static constexpr size_t MAX_LEVELS = 8;
 
+		// Count of shapes per bucket quad, which the building of tree aims for.
+		static constexpr size_t BUCKET_SHAPES = 64;
+
+		// Maximum level of bucket quads, where the building of tree places the shapes.
+		static constexpr size_t MAX_BUCKET_LEVEL = 6;
+
+		// Level of quads, where the locking of concurrent updates starts. Quads above it stay in place while the concurrent updates are enabled.
+		static constexpr size_t CONCURRENT_ENTRY_LEVEL = 4;
+
 	public:
 		// Reset the indexing tree. Building of tree is required after reset and before the searching.
 		void Reset();
@@ -38,8 +60,65 @@ namespace Internal
 		// Pop the shape from indexing tree.
 		void Pop( const Shape& shape );
 
+		// Re-index the shape, that was moved from `previous_bounds` to its current bounds.
+		void Move( const Shape& shape, const Demo::BoundingRect& previous_bounds );
+
 		// Search for indexed shapes in a given bounds.
-		std::vector<const Shape*> Find( const Demo::BoundingRect& bounds ) const;
+		QueryResult Find( const Demo::BoundingRect& bounds );
+
+		// Search for indexed shapes in a given bounds. Searching starts from the quad, remembered by hint, instead of the root.
+		// The deepest quad enclosing the bounds with no shared edge is remembered by hint afterwards.
+		QueryResult Find( const Demo::BoundingRect& bounds, QueryHint& hint );
+
+		// Search for indexed shapes in a given bounds, which belong to any of given categories.
+		// Quads with no shape of given categories are pruned with all their subtrees.
+		QueryResult Find( const Demo::BoundingRect& bounds, const uint64_t categories );
+
+		// Search for indexed shapes in a given bounds, which were changed at given epoch or later.
+		// Quads with no shape changed since the epoch are pruned with all their subtrees.
+		QueryResult FindChangedSince( const Demo::BoundingRect& bounds, const uint64_t epoch );
+
+
+		// Search for indexed shapes in a given convex polygon.
+		QueryResult Find( const ConvexPolygon& polygon );
+
+
+		// Search for indexed shapes hit by the bounds, moving along the displacement. Result is ordered by the time of impact.
+		// Quads are pruned along the path of sweeping. Only the earliest hit is searched if `is_first_hit_only` is set.
+		SweepResult FindSwept( const Demo::BoundingRect& bounds, const Vector2f& displacement, const bool is_first_hit_only );
+
+
+		// Report each pair of intersecting shapes from this and the `other` trees. Shapes of this tree are passed to the left.
+		// Both trees are descended simultaneously, so the pairs of quads with no intersection are pruned with all their subtrees.
+		// If `threads_count` is greater than one, pairs of subtrees are joined concurrently and the callback is called from several threads.
+		// Both trees are completely refined before the joining.
+		void Join( IndexTree& other, const JoinCallback& callback, const size_t threads_count );
+
+
+		// Whether any indexed shape lies in a given bounds. Searching stops at first found shape.
+		const bool Any( const Demo::BoundingRect& bounds );
+
+		// Count the indexed shapes in a given bounds. Subtrees inside the bounds are counted with no enumeration of shapes.
+		const size_t Count( const Demo::BoundingRect& bounds );
+
+		// Aggregate the indexed shapes by cells of the grid over given bounds. Shape is accounted by the cell, which contains its center.
+		// Subtrees, which lie inside single cell, are accounted by their totals. Only the quads crossing the borders of cells are descended.
+		HistogramResult Histogram( const Demo::BoundingRect& bounds, const size_t columns, const size_t rows );
+
+		// Search for up to `count` largest indexed shapes in a given bounds, measured by the key. Result is ordered by descending size.
+		// Quads are visited in order of the upper limit of their shape sizes, so the shallow quads with the largest shapes go first.
+		// Searching stops once no unvisited quad may hold a larger shape or once `visits_budget` quads were visited.
+		QueryResult FindTop( const Demo::BoundingRect& bounds, const size_t count, const SizeKey key, const size_t visits_budget );
+
+
+		// Lay out the quads of tree in memory in order of traversal. The tree is completely refined, then each quad is relocated
+		// to the single page, so the quarters of each quad are placed next to each other and before the deeper quads of subtree.
+		// Arrays of shapes are reallocated in the same order. Hints made before the optimization are dropped.
+		void Optimize();
+
+
+		// Enable or disable the concurrent pushing and popping of shapes. Disabling tidies the tree after the concurrent updates.
+		void SetConcurrentUpdates( const bool is_enabled );
 
 		// Whether the tree is empty (not built).
 		inline const bool IsEmpty() const			{ return m_root == nullptr; };
@@ -47,10 +126,67 @@ namespace Internal
 		// Whether the tree is built.
 		inline const bool IsBuilt() const			{ return m_root != nullptr; };
 
+		// Whether the shapes may be pushed and popped concurrently.
+		inline const bool IsConcurrentUpdates() const	{ return m_is_concurrent_updates; };
+
+	// Private inner types.
 	private:
+		// Filter of searched shapes. Default filter passes any shape.
+		struct ShapeFilter final
+		{
+			uint64_t	categories	= Shape::ALL_CATEGORIES;	// Shapes of any of these categories pass the filter.
+			uint64_t	epoch		= 0;						// Shapes changed at this epoch or later pass the filter.
+		};
+
+		// Shapes pushed and popped concurrently by the threads of single shard.
+		// Stages are aligned to cache lines, so the threads of different shards do not share the lines.
+		struct alignas( 64 ) UpdateStage final
+		{
+			std::mutex	mutex;			// Guard for the shapes of stage.
+			Shapes		pushed_shapes;	// Shapes pushed concurrently, which are not in the collection of shapes yet.
+			Shapes		popped_shapes;	// Shapes popped concurrently, which are still in the collection of shapes or in some stage.
+		};
+
+	private:
+		// Search for indexed shapes in a given area. The area should be able to classify and to intersect the bounding rects.
+		// Only the shapes passing the filter are searched. Quads with no such shapes are pruned with all their subtrees.
+		template< typename TArea >
+		QueryResult FindInArea( const TArea& area, Quad& top_quad, const ShapeFilter& filter );
+
+
+		// Search for the earliest hit of bounds, moving along the displacement. Quads are visited in order of their own time of impact.
+		SweepResult FindFirstHit( const Demo::BoundingRect& bounds, const Vector2f& displacement );
+
+
+		// Get the shared pointer, which owns the given quad.
+		std::shared_ptr<Quad> GetSharedQuad( Quad& quad ) const;
+
+
+		// Distribute the pending shapes of quad among the quad itself and its quarters. Quarters receive the shapes as pending ones.
+		void RefineQuad( Quad& quad );
+
+		// Distribute the pending shapes in the whole subtree of quad.
+		void RefineSubtree( Quad& quad );
+
+
+		// Place the shape to the bucket quad of given level, which encloses the shape, or to the upper quad, if the shape crosses its quarters.
+		void BucketShape( const Shape& shape, const size_t bucket_level );
+
+		// Refine and split the quads above the entry level of concurrent updates in the subtree of quad, creating all their quarters.
+		void FreezeSubtree( Quad& quad );
+
+
+		// Relocate the quarters of `source` quad to newly created quarters of `target` one, then relocate the subtrees of quarters.
+		void RelocateQuarters( const Quad& source, Quad& target );
+
+
 		// Perform the shape re-indexation.
 		void ReindexShape( Quad& quad, const Shape& shape );
 
+		// Perform the shape re-indexation from the root, while other threads update the tree concurrently.
+		// Frozen levels are descended with no locks, then the quads from the entry level down are locked one after another.
+		void ReindexShapeConcurrently( const Shape& shape );
+
 
 		// Split the quad with indexed shapes to quarters.
 		void SplitToQuarters( Quad& quad );
@@ -60,6 +196,9 @@ namespace Internal
 
 		QuadProvider			m_quad_provider;	// Provider of quads.
 		std::shared_ptr<Quad>	m_root;				// The root of tree.
+
+		std::array<UpdateStage, THREAD_SHARDS_COUNT>	m_update_stages;					// Stages of concurrent updates, one per shard of threads.
+		bool											m_is_concurrent_updates	= false;	// Whether the shapes may be pushed and popped concurrently.
 	};
 }
 }
@@ -0,0 +1,23 @@
+#include <demo/spatial/spatial.h>
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+namespace Internal
+{
+	void QuadLock::lock()
+	{
+		// The flag is only read while it is taken, so the waiting threads do not fight for the cache line.
+		while( !try_lock() )
+		{
+			while( m_is_locked.load( std::memory_order_relaxed ) )
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+}
+}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+namespace Internal
+{
+	/**
+		@brief	Lock of single quad.
+
+		Lock is the spinning flag, so it takes just a byte of quad. Waiting thread yields between the attempts to take the lock.
+		Copying of lock gives the unlocked one, so the quads stay copyable. Lock is never copied while it is taken.
+
+		Lock has the lowercase interface of standard `Lockable` requirements, so it may be used with `std::unique_lock` and `std::lock_guard`.
+	*/
+	class QuadLock final
+	{
+	// Lifetime management.
+	public:
+		inline QuadLock() noexcept = default;
+		inline QuadLock( const QuadLock& ) noexcept								{};
+
+
+		inline QuadLock& operator = ( const QuadLock& ) noexcept				{ return *this; };
+
+	// Public interface.
+	public:
+		// Take the lock, waiting until it is released by other thread.
+		void lock();
+
+		// Try to take the lock with no waiting. Returns whether the lock was taken.
+		inline const bool try_lock()		{ return !m_is_locked.exchange( true, std::memory_order_acquire ); };
+
+		// Release the lock.
+		inline void unlock()				{ m_is_locked.store( false, std::memory_order_release ); };
+
+	// Private state.
+	private:
+		std::atomic<bool>	m_is_locked{ false };	// Whether the lock is taken.
+	};
+}
+}
+}
@@ -7,26 +7,98 @@ inline namespace Spatial
 {
 namespace Internal
 {
-	std::shared_ptr<Quad> QuadProvider::Create( const BoundingRect& bounds, const size_t level )
+	std::shared_ptr<Quad> QuadProvider::Create( const BoundingRect& bounds, const size_t level, Quad* parent )
 	{
-		auto& quad = m_slots.emplace_back();
+		const size_t shard_index = GetThreadShardIndex();
+		Shard& shard = m_shards[ shard_index ];
 
-		quad.bounds		= bounds;
-		quad.center		= bounds.GetCenter();
-		quad.level		= level;
-		quad.is_leaf	= true;
+		std::lock_guard<std::mutex> lock{ shard.mutex };
 
-		return { &quad, [this, slot = std::prev( m_slots.end() )]( Quad* ) { Destroy( slot ); } };
+		size_t page_index	= shard.current_page;
+		Quad* quad			= nullptr;
+		if( ( page_index < shard.pages.size() ) && ( shard.pages[ page_index ].used_count < shard.pages[ page_index ].capacity ) )
+		{
+			quad = &shard.pages[ page_index ].slots[ shard.pages[ page_index ].used_count++ ];
+		}
+		else if( !shard.free_slots.empty() )
+		{
+			page_index	= shard.free_slots.back().page_index;
+			quad		= shard.free_slots.back().quad;
+			shard.free_slots.pop_back();
+		}
+		else
+		{
+			page_index	= AddPage( shard, PAGE_SIZE );
+			quad		= &shard.pages[ page_index ].slots[ shard.pages[ page_index ].used_count++ ];
+		}
+
+		++shard.pages[ page_index ].alive_count;
+
+		quad->bounds	= bounds;
+		quad->center	= bounds.GetCenter();
+		quad->level		= level;
+		quad->parent	= parent;
+		quad->is_leaf	= true;
+
+		return { quad, [this, shard_index, page_index]( Quad* slot ) { Destroy( shard_index, page_index, slot ); } };
 	}
 
-	void QuadProvider::Destroy( std::list<Quad>::iterator slot )
+	void QuadProvider::Reserve( const size_t count )
 	{
-		for( auto& quarter : slot->quarters )
+		Shard& shard = m_shards[ GetThreadShardIndex() ];
+
+		std::lock_guard<std::mutex> lock{ shard.mutex };
+		AddPage( shard, count );
+	}
+
+	void QuadProvider::Destroy( const size_t shard_index, const size_t page_index, Quad* quad )
+	{
+		// Quarters are destroyed recursively here, before the shard is locked.
+		*quad = {};
+
+		Shard& shard = m_shards[ shard_index ];
+		std::lock_guard<std::mutex> lock{ shard.mutex };
+
+		Page& page = shard.pages[ page_index ];
+		if( ( --page.alive_count > 0 ) || ( page_index == shard.current_page ) )
 		{
-			quarter.reset();
+			shard.free_slots.push_back( { page_index, quad } );
+			return;
 		}
 
-		m_slots.erase( slot );
+		ReleasePage( shard, page_index );
+	}
+
+	const size_t QuadProvider::AddPage( Shard& shard, const size_t capacity )
+	{
+		// Current page is released once it stops being current, if it has no alive quads.
+		if( ( shard.current_page < shard.pages.size() ) && ( shard.pages[ shard.current_page ].alive_count == 0 ) )
+		{
+			ReleasePage( shard, shard.current_page );
+		}
+
+		// Slots of released pages are reused for new pages.
+		auto found_page = std::find_if( shard.pages.begin(), shard.pages.end(), []( const Page& page ) { return page.capacity == 0; } );
+		if( found_page == shard.pages.end() )
+		{
+			found_page = shard.pages.emplace( shard.pages.end() );
+		}
+
+		found_page->slots		= std::make_unique<Quad[]>( capacity );
+		found_page->capacity	= capacity;
+
+		shard.current_page = size_t( std::distance( shard.pages.begin(), found_page ) );
+		return shard.current_page;
+	}
+
+	void QuadProvider::ReleasePage( Shard& shard, const size_t page_index )
+	{
+		shard.free_slots.erase(
+			std::remove_if( shard.free_slots.begin(), shard.free_slots.end(), [page_index]( const FreeSlot& slot ) { return slot.page_index == page_index; } ),
+			shard.free_slots.end()
+		);
+
+		shard.pages[ page_index ] = {};
 	}
 }
 }
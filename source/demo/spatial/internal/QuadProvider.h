@@ -10,24 +10,70 @@ namespace Internal
 	/**
 		@brief	Provider of quad instances.
 
-		This provider is a mock for true quad memory pool.
-		Currently it only gives the valid interface to create the quads.
+		Provider stores the quads in pages. Quads are taken from the current page sequentially, then the released slots are reused.
+		Page is released once the last of its quads is destroyed.
+
+		The reserving of page allows to place a known count of quads next to each other, so the tree may be laid out in order of traversal.
+		Pages are split between the shards, each guarded by its own mutex. Each thread creates the quads using its own shard,
+		so the quads may be created and destroyed by several threads at once with no contention. Quad is destroyed by the shard,
+		which created it, regardless of the destroying thread. Reserved page belongs to the shard of reserving thread.
 	*/
 	class QuadProvider final
 	{
+	// Public constants.
+	public:
+		// Count of quads in regular page.
+		static constexpr size_t PAGE_SIZE = 256;
+
 	// Public interface.
 	public:
 		// Create new quad. The instance returned will be destroyed once there no shared pointers reference it.
-		std::shared_ptr<Quad> Create( const BoundingRect& bounds, const size_t level );
+		std::shared_ptr<Quad> Create( const BoundingRect& bounds, const size_t level, Quad* parent );
+
+		// Start new page for the given count of quads. The next `count` created quads are placed sequentially in this page.
+		void Reserve( const size_t count );
+
+	// Private inner types.
+	private:
+		// Page of quads.
+		struct Page final
+		{
+			std::unique_ptr<Quad[]>	slots;				// Storage for quads.
+			size_t					capacity	= 0;	// Count of slots in page.
+			size_t					used_count	= 0;	// Count of slots taken sequentially from the beginning of page.
+			size_t					alive_count	= 0;	// Count of quads currently alive in page.
+		};
+
+		// Released slot, available to be reused.
+		struct FreeSlot final
+		{
+			size_t	page_index;	// Index of page, which stores the slot.
+			Quad*	quad;		// Slot itself.
+		};
+
+		// Shard of provider. Shards are aligned to cache lines, so the threads of different shards do not share the lines.
+		struct alignas( 64 ) Shard final
+		{
+			std::mutex				mutex;					// Guard for the state of shard.
+			std::vector<Page>		pages;					// Pages of quads. Released pages are left empty to keep the indices of pages.
+			std::vector<FreeSlot>	free_slots;				// Released slots of pages.
+			size_t					current_page	= 0;	// Index of page, where the quads are taken sequentially.
+		};
 
 	// Private interface.
 	private:
-		// Perform the quad destruction by given iterator.
-		void Destroy( std::list<Quad>::iterator slot );
+		// Perform the quad destruction.
+		void Destroy( const size_t shard_index, const size_t page_index, Quad* quad );
+
+		// Add new page with given count of slots to the shard and make it current. Returns the index of page.
+		const size_t AddPage( Shard& shard, const size_t capacity );
+
+		// Release the storage of page with no alive quads, along with its free slots.
+		void ReleasePage( Shard& shard, const size_t page_index );
 
 	// Private state.
 	private:
-		std::list<Quad>	m_slots; // Storage for quads.
+		std::array<Shard, THREAD_SHARDS_COUNT> m_shards; // Shards of provider.
 	};
 }
 }
@@ -0,0 +1,28 @@
+#include <demo/spatial/spatial.h>
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+namespace Internal
+{
+namespace
+{
+	// Memory resource installed for the current thread.
+	thread_local std::pmr::memory_resource* g_query_resource = nullptr;
+}
+
+
+	std::pmr::memory_resource* GetQueryResource()
+	{
+		return ( g_query_resource != nullptr )? g_query_resource : std::pmr::get_default_resource();
+	}
+
+	std::pmr::memory_resource* ExchangeQueryResource( std::pmr::memory_resource* resource )
+	{
+		return std::exchange( g_query_resource, resource );
+	}
+}
+}
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+namespace Internal
+{
+	// Get the memory resource for spatial searching on the current thread. The default resource is returned if no arena installed.
+	std::pmr::memory_resource* GetQueryResource();
+
+	// Install the memory resource for spatial searching on the current thread. The previously installed resource is returned.
+	std::pmr::memory_resource* ExchangeQueryResource( std::pmr::memory_resource* resource );
+}
+}
+}
@@ -0,0 +1,177 @@
+#include <demo/spatial/spatial.h>
+
+#include <cstring>
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+namespace Internal
+{
+namespace
+{
+	// Count of bits processed by single pass of radix sort.
+	constexpr size_t RADIX_BITS = 8;
+
+	// Count of buckets for single pass of radix sort.
+	constexpr size_t RADIX_BUCKETS = size_t( 1 ) << RADIX_BITS;
+
+	// Count of passes to sort the whole key.
+	constexpr size_t RADIX_PASSES = sizeof( uint64_t ) * 8 / RADIX_BITS;
+
+
+	// Shape with the sorting key.
+	struct KeyedShape final
+	{
+		uint64_t		key;	// Key to sort by.
+		const Shape*	shape;	// Shape to be sorted.
+	};
+
+
+	// Get the digit of key for given pass of radix sort.
+	inline const size_t GetDigit( const uint64_t key, const size_t pass )
+	{
+		return size_t( key >> ( pass * RADIX_BITS ) ) & ( RADIX_BUCKETS - 1 );
+	}
+
+	// Translate the non-negative float value to the key with the same ordering.
+	inline const uint64_t ToKey( const float value )
+	{
+		uint32_t bits;
+		std::memcpy( &bits, &value, sizeof( bits ) );
+		return bits;
+	}
+
+	// Translate the key back to the float value.
+	inline const float FromKey( const uint64_t key )
+	{
+		const uint32_t bits = uint32_t( key );
+
+		float value;
+		std::memcpy( &value, &bits, sizeof( value ) );
+		return value;
+	}
+
+	// Get the quadratic distance from point to the nearest point of rect.
+	const float GetSquareDistance( const BoundingRect& rect, const Vector2f& point )
+	{
+		const Vector2f nearest_point{ std::clamp( point.x, rect.min.x, rect.max.x ), std::clamp( point.y, rect.min.y, rect.max.y ) };
+		return ( point - nearest_point ).GetSquareLength();
+	}
+
+	// Get the sorting key of shape for given options.
+	const uint64_t GetKey( const Shape& shape, const QueryOptions& options )
+	{
+		switch( options.order )
+		{
+			case ResultOrder::ByTag:
+				return uint64_t( shape.GetTag() );
+			case ResultOrder::ByDistance:
+				return ToKey( GetSquareDistance( shape.GetBounds(), options.origin ) );
+			default:
+				return uint64_t( reinterpret_cast<uintptr_t>( &shape ) );
+		}
+	}
+
+	// Perform the stable LSD radix sort of shapes by their keys. Passes with only one filled bucket are skipped.
+	void RadixSort( std::pmr::vector<KeyedShape>& shapes )
+	{
+		std::array<std::array<size_t, RADIX_BUCKETS>, RADIX_PASSES> histograms{};
+		for( const auto& shape : shapes )
+		{
+			for( size_t pass = 0; pass < RADIX_PASSES; ++pass )
+			{
+				++histograms[ pass ][ GetDigit( shape.key, pass ) ];
+			}
+		}
+
+		std::pmr::vector<KeyedShape> buffer( shapes.size(), GetQueryResource() );
+		for( size_t pass = 0; pass < RADIX_PASSES; ++pass )
+		{
+			auto& histogram = histograms[ pass ];
+			if( histogram[ GetDigit( shapes.front().key, pass ) ] == shapes.size() )
+			{
+				continue;
+			}
+
+			size_t offset = 0;
+			for( auto& bucket : histogram )
+			{
+				offset += std::exchange( bucket, offset );
+			}
+
+			for( const auto& shape : shapes )
+			{
+				buffer[ histogram[ GetDigit( shape.key, pass ) ]++ ] = shape;
+			}
+
+			shapes.swap( buffer );
+		}
+	}
+
+	// Perform the sorting of shapes by the key, selected with given options.
+	void SortShapes( QueryResult& result, const QueryOptions& options )
+	{
+		std::pmr::vector<KeyedShape> keyed_shapes{ GetQueryResource() };
+		keyed_shapes.reserve( result.size() );
+		for( const auto shape : result )
+		{
+			keyed_shapes.push_back( { GetKey( *shape, options ), shape } );
+		}
+
+		RadixSort( keyed_shapes );
+
+		std::transform( keyed_shapes.begin(), keyed_shapes.end(), result.begin(), []( const KeyedShape& shape ) { return shape.shape; } );
+	}
+}
+
+
+	void OrderResult( QueryResult& result, const QueryOptions& options )
+	{
+		if( result.size() < 2 )
+		{
+			return;
+		}
+
+		// Repeated shapes are gathered together by the memory ordering, so it should precede any other ordering.
+		if( options.deduplicate )
+		{
+			SortShapes( result, { ResultOrder::ByMemory } );
+			result.erase( std::unique( result.begin(), result.end() ), result.end() );
+		}
+
+		if( ( options.order == ResultOrder::None ) || ( options.deduplicate && ( options.order == ResultOrder::ByMemory ) ) )
+		{
+			return;
+		}
+
+		SortShapes( result, options );
+	}
+
+	void OrderHits( SweepResult& result )
+	{
+		if( result.size() < 2 )
+		{
+			return;
+		}
+
+		std::pmr::vector<KeyedShape> keyed_shapes{ GetQueryResource() };
+		keyed_shapes.reserve( result.size() );
+		for( const auto& hit : result )
+		{
+			keyed_shapes.push_back( { ToKey( hit.time ), hit.shape } );
+		}
+
+		RadixSort( keyed_shapes );
+
+		std::transform(
+			keyed_shapes.begin(),
+			keyed_shapes.end(),
+			result.begin(),
+			[]( const KeyedShape& shape ) -> SweepHit { return { shape.shape, FromKey( shape.key ) }; }
+		);
+	}
+}
+}
+}
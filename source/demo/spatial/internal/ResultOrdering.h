@@ -0,0 +1,17 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+namespace Internal
+{
+	// Perform the ordering and compaction of spatial searching result, as described by given options.
+	void OrderResult( QueryResult& result, const QueryOptions& options );
+
+	// Perform the ordering of sweeping result by the time of impact.
+	void OrderHits( SweepResult& result );
+}
+}
+}
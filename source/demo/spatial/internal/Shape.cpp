@@ -12,12 +12,22 @@ namespace Internal
 	Shape::Shape( QuadTree& host, const BoundingRect& bounds ) noexcept
 		: m_host{ host }
 		, m_bounds{ bounds }
+		, m_epoch{ host.GetEpoch() }
 	{
 	}
 
 	void Shape::SetBounds( const BoundingRect& bounds )
 	{
-		m_bounds = bounds;
+		const BoundingRect previous_bounds{ std::exchange( m_bounds, bounds ) };
+		m_epoch = m_host.GetEpoch();
+		m_host.UpdateShape( *this, previous_bounds );
+	}
+
+	void Shape::SetCategories( const uint64_t mask )
+	{
+		m_categories	= mask;
+		m_epoch			= m_host.GetEpoch();
+		m_host.UpdateCategories( *this );
 	}
 }
 }
@@ -12,9 +12,15 @@ namespace Internal
 
 		Shapes are interface to communicate with spatial index. Shape is described by bounding rect. Shapes are indexed in quadtree.
 		Once the shape moves the bounds using `SetBounds`, it always re-indexed until it goes out indexing bounds.
+		Each change of bounds or categories marks the shape by the current epoch of host tree.
 	*/
 	class Shape final
 	{
+	// Public constants.
+	public:
+		// Mask of all categories. Shapes belong to all categories by default.
+		static constexpr uint64_t ALL_CATEGORIES = ~uint64_t( 0 );
+
 	// Lifetime management.
 	public:
 		Shape() = delete;
@@ -31,6 +37,9 @@ namespace Internal
 		// Set the abstract tag for shape.
 		inline void SetTag( const size_t value )						{ m_tag = value; };
 
+		// Set the mask of categories for shape. The shape is re-indexed, so the masks of quads stay consistent.
+		void SetCategories( const uint64_t mask );
+
 
 		// Get current bounds of shape.
 		inline const BoundingRect& GetBounds() const					{ return m_bounds; };
@@ -38,12 +47,20 @@ namespace Internal
 		// Get the abstract tag of shape.
 		inline const size_t GetTag() const								{ return m_tag; };
 
+		// Get the mask of categories of shape.
+		inline const uint64_t GetCategories() const						{ return m_categories; };
+
+		// Get the epoch of host tree, when the shape was acquired or changed last time.
+		inline const uint64_t GetEpoch() const							{ return m_epoch; };
+
 	// Private state.
 	private:
 		QuadTree&		m_host;				// Quad tree that host shape.
 		BoundingRect	m_bounds;			// Bounds of shape.
 
-		size_t			m_tag		= 0;	// Abstract tag.
+		size_t			m_tag			= 0;				// Abstract tag.
+		uint64_t		m_categories	= ALL_CATEGORIES;	// Mask of categories, the shape belongs to.
+		uint64_t		m_epoch;							// Epoch of the last change of shape.
 	};
 }
 }
@@ -9,52 +9,55 @@ namespace Internal
 {
 namespace
 {
-	// Translate the 2D shape index to shape handle.
-	const ShapeProvider::Handle ToHandle( const size_t bucket_index, const size_t slot_index )
+	// Translate the 3D shape index to shape handle.
+	const ShapeProvider::Handle ToHandle( const size_t shard_index, const size_t bucket_index, const size_t slot_index )
 	{
-		return ShapeProvider::Handle{ bucket_index * ShapeProvider::BUCKET_LENGTH + slot_index };
+		return ShapeProvider::Handle{ ( bucket_index * ShapeProvider::BUCKET_LENGTH + slot_index ) * ShapeProvider::SHARDS_COUNT + shard_index };
 	}
 
-	// Translate the shape handle to 2D shape index.
-	std::pair<size_t, size_t> FromHandle( const ShapeProvider::Handle handle )
+	// Translate the shape handle to 3D shape index.
+	std::tuple<size_t, size_t, size_t> FromHandle( const ShapeProvider::Handle handle )
 	{
-		return { size_t( handle ) / ShapeProvider::BUCKET_LENGTH, size_t( handle ) % ShapeProvider::BUCKET_LENGTH };
-	}
-
-	// Whether the bucket consists of any free slot for new shape.
-	const bool HasFreeSlot( const ShapeProvider::Bucket& bucket )
-	{
-		return std::any_of( bucket.begin(), bucket.end(), []( const std::optional<Shape>& slot ) { return !slot.has_value(); } );
-	}
-
-	// Get the shape slot from given storage by given handle.
-	std::optional<Shape>& GetSlot( const ShapeProvider::BucketStorage& storage, const ShapeProvider::Handle handle )
-	{
-		auto [ bucket_index, slot_index ] = FromHandle( handle );
-		return storage.at( bucket_index )->at( slot_index );
+		const size_t slot_number = size_t( handle ) / ShapeProvider::SHARDS_COUNT;
+		return { size_t( handle ) % ShapeProvider::SHARDS_COUNT, slot_number / ShapeProvider::BUCKET_LENGTH, slot_number % ShapeProvider::BUCKET_LENGTH };
 	}
 }
 
 
 	std::pair<Shape*, ShapeProvider::Handle> ShapeProvider::Create( QuadTree& host, const BoundingRect& bounds )
 	{
-		auto suitable_bucket = std::find_if( m_slots.begin(), m_slots.end(), []( const std::unique_ptr<Bucket>& bucket ) { return HasFreeSlot( *bucket ); } );
-		if( suitable_bucket == m_slots.end() )
+		const size_t shard_index = GetThreadShardIndex();
+		Shard& shard = m_shards[ shard_index ];
+
+		std::lock_guard<std::mutex> lock{ shard.mutex };
+		if( shard.free_slots.empty() )
 		{
-			m_slots.emplace_back( std::make_unique<Bucket>() );
-			suitable_bucket = std::prev( m_slots.end() );
+			const size_t bucket_index = shard.slots.size();
+			shard.slots.emplace_back( std::make_unique<Bucket>() );
+
+			// Slots of new bucket are taken from its beginning.
+			for( size_t slot_index = BUCKET_LENGTH; slot_index > 0; --slot_index )
+			{
+				shard.free_slots.push_back( ToHandle( shard_index, bucket_index, slot_index - 1 ) );
+			}
 		}
 
-		Bucket& bucket = *suitable_bucket->get();
-		auto suitable_slot = std::find_if( bucket.begin(), bucket.end(), []( const std::optional<Shape>& slot ) { return !slot.has_value(); } );
+		const Handle handle = shard.free_slots.back();
+		shard.free_slots.pop_back();
 
-		Shape& shape = suitable_slot->emplace( host, bounds );
-		return { &shape, ToHandle( std::distance( m_slots.begin(), suitable_bucket ), std::distance( bucket.begin(), suitable_slot ) ) };
+		const auto [ handle_shard_index, bucket_index, slot_index ] = FromHandle( handle );
+		Shape& shape = shard.slots[ bucket_index ]->at( slot_index ).emplace( host, bounds );
+		return { &shape, handle };
 	}
 
 	void ShapeProvider::Destroy( const Handle handle )
 	{
-		GetSlot( m_slots, handle ).reset();
+		const auto [ shard_index, bucket_index, slot_index ] = FromHandle( handle );
+		Shard& shard = m_shards[ shard_index ];
+
+		std::lock_guard<std::mutex> lock{ shard.mutex };
+		shard.slots.at( bucket_index )->at( slot_index ).reset();
+		shard.free_slots.push_back( handle );
 	}
 }
 }
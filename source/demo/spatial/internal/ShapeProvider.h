@@ -14,6 +14,10 @@ namespace Internal
 		Slots are packed in buckets with length of `BUCKET_LENGTH`, obviously. Buckets are created dynamically and owned by `std::vector` via `std::unique_ptr`.
 		All of it forms the 2D grid of shape slots and each shape can be indexed through the 2D point in integer space.
 		Such 2D point is packed in value of inner type `Handle`. Each created shape supplied with handle since the destruction of shape is allowed only by handle.
+
+		Buckets are split between `SHARDS_COUNT` shards, each guarded by its own mutex and keeping its own list of free slots.
+		Each thread creates the shapes using its own shard, so the shapes may be created and destroyed by several threads at once.
+		Handle also holds the index of shard, so the shape is destroyed by its shard regardless of the destroying thread.
 	*/
 	class ShapeProvider final
 	{
@@ -22,6 +26,9 @@ namespace Internal
 		// Length of single bucket.
 		static constexpr size_t BUCKET_LENGTH = 8;
 
+		// Count of shards, which create the shapes independently.
+		static constexpr size_t SHARDS_COUNT = THREAD_SHARDS_COUNT;
+
 	// Public inner types.
 	public:
 		// Handle of create shape.
@@ -36,15 +43,25 @@ namespace Internal
 
 	// Public interface.
 	public:
-		// Create the new shape.
+		// Create the new shape, using the shard of calling thread.
 		std::pair<Shape*, Handle> Create( QuadTree& host, const BoundingRect& bounds );
 
 		// Destroy the previously created shape by given handle.
 		void Destroy( const Handle handle );
 
+	// Private inner types.
+	private:
+		// Shard of provider. Shards are aligned to cache lines, so the threads of different shards do not share the lines.
+		struct alignas( 64 ) Shard final
+		{
+			std::mutex			mutex;			// Guard for the state of shard.
+			BucketStorage		slots;			// Storage for shape slots.
+			std::vector<Handle>	free_slots;		// Handles of free slots. The last one is taken first.
+		};
+
 	// Internal state.
 	private:
-		BucketStorage m_slots; // Storage for shape slots.
+		std::array<Shard, SHARDS_COUNT> m_shards; // Shards of provider.
 	};
 }
 }
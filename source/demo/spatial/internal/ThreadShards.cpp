@@ -0,0 +1,19 @@
+#include <demo/spatial/spatial.h>
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+namespace Internal
+{
+	const size_t GetThreadShardIndex()
+	{
+		static std::atomic<size_t> next_shard_index{ 0 };
+		static thread_local const size_t shard_index = next_shard_index.fetch_add( 1, std::memory_order_relaxed ) % THREAD_SHARDS_COUNT;
+
+		return shard_index;
+	}
+}
+}
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+namespace Internal
+{
+	// Count of shards, which the state updated by several threads at once is split between. Each thread uses its own shard.
+	constexpr size_t THREAD_SHARDS_COUNT = 16;
+
+
+	// Get the index of shard for calling thread. Shards are given to the threads in turn, at their first use.
+	const size_t GetThreadShardIndex();
+}
+}
+}
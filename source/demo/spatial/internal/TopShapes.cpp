@@ -0,0 +1,71 @@
+#include <demo/spatial/spatial.h>
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+namespace Internal
+{
+namespace
+{
+	// Ordering of heap, which places the smallest shape at front.
+	template< typename TSizedShape >
+	const bool IsLarger( const TSizedShape& left, const TSizedShape& right )
+	{
+		return left.size > right.size;
+	}
+}
+
+
+	TopShapes::TopShapes( const size_t count, const SizeKey key )
+		: m_shapes{ GetQueryResource() }
+		, m_count{ count }
+		, m_key{ key }
+	{
+		// Requested count may be arbitrarily large, while the count of kept shapes is bound by the count of indexed ones.
+		m_shapes.reserve( std::min( count, MAX_RESERVED_COUNT ) );
+	}
+
+	void TopShapes::Push( const Shape& shape )
+	{
+		const float size = Measure( shape.GetBounds().GetSize() );
+		if( IsSaturated( size ) )
+		{
+			return;
+		}
+
+		if( m_shapes.size() == m_count )
+		{
+			std::pop_heap( m_shapes.begin(), m_shapes.end(), IsLarger<SizedShape> );
+			m_shapes.pop_back();
+		}
+
+		m_shapes.push_back( { &shape, size } );
+		std::push_heap( m_shapes.begin(), m_shapes.end(), IsLarger<SizedShape> );
+	}
+
+	QueryResult TopShapes::TakeResult()
+	{
+		std::sort_heap( m_shapes.begin(), m_shapes.end(), IsLarger<SizedShape> );
+
+		QueryResult result{ GetQueryResource() };
+		result.reserve( m_shapes.size() );
+		std::transform( m_shapes.begin(), m_shapes.end(), std::back_inserter( result ), []( const SizedShape& shape ) { return shape.shape; } );
+
+		m_shapes.clear();
+		return result;
+	}
+
+	const float TopShapes::Measure( const Vector2f& size ) const
+	{
+		return ( m_key == SizeKey::Area )? size.x * size.y : std::max( size.x, size.y );
+	}
+
+	const bool TopShapes::IsSaturated( const float size ) const
+	{
+		return ( m_shapes.size() == m_count ) && ( ( m_count == 0 ) || ( m_shapes.front().size >= size ) );
+	}
+}
+}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+
+namespace Demo
+{
+inline namespace Spatial
+{
+namespace Internal
+{
+	/**
+		@brief	Collection of the largest shapes.
+
+		Collection keeps up to the given count of offered shapes, which sizes are the largest. Size of shape is measured on its bounds by the key.
+		Shapes are kept in the heap, so the smallest kept shape is replaced by the larger one in logarithmic time.
+		Memory for collection is provided by the query memory resource.
+	*/
+	class TopShapes final
+	{
+	// Public constants.
+	public:
+		// Maximum count of shapes, which the memory is reserved for at once. Collection grows beyond it only as the shapes are kept.
+		static constexpr size_t MAX_RESERVED_COUNT = 64;
+
+	// Lifetime management.
+	public:
+		TopShapes( const size_t count, const SizeKey key );
+
+	// Public interface.
+	public:
+		// Offer the shape to collection. The shape is kept only if it is larger than the smallest kept one or the collection is not full.
+		void Push( const Shape& shape );
+
+		// Take the kept shapes, ordered by descending size. The collection is empty afterwards.
+		QueryResult TakeResult();
+
+
+		// Measure the size of bounds with given size, using the key of collection.
+		const float Measure( const Vector2f& size ) const;
+
+		// Whether the collection is full and no shape of given size would be kept.
+		const bool IsSaturated( const float size ) const;
+
+	// Private inner types.
+	private:
+		// Shape along with its measured size.
+		struct SizedShape final
+		{
+			const Shape*	shape;	// Kept shape.
+			float			size;	// Measured size of shape.
+		};
+
+	// Private state.
+	private:
+		std::pmr::vector<SizedShape>	m_shapes;	// Heap of kept shapes, the smallest one is at front.
+		size_t							m_count;	// Maximum count of kept shapes.
+		SizeKey							m_key;		// Key to measure the shapes.
+	};
+}
+}
+}
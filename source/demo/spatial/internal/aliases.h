@@ -10,6 +10,21 @@ namespace Internal
 	// Collection of indexed shapes.
 	using Shapes = std::vector<const Shape*>;
 
+	// Collection of bounds of indexed shapes. Bounds are stored along with the shapes, so the shapes may be tested in batches.
+	using ShapesBounds = std::vector<Demo::BoundingRect>;
+
+	// Collection of found shapes. Memory for collection is provided by the query memory resource.
+	using QueryResult = std::pmr::vector<const Shape*>;
+
+	// Collection of shapes hit by sweeping. Memory for collection is provided by the query memory resource.
+	using SweepResult = std::pmr::vector<SweepHit>;
+
+	// Dense grid of histogram cells, stored row by row. Memory for collection is provided by the query memory resource.
+	using HistogramResult = std::pmr::vector<HistogramCell>;
+
+	// Function to be called for each pair of intersecting shapes, found by the joining of indexes.
+	using JoinCallback = std::function<void( const Shape& left, const Shape& right )>;
+
 	// Collection of quad quarters.
 	using Quarters = std::array<std::shared_ptr<Quad>, Demo::BoundingRect::CORNERS_COUNT>;
 }
@@ -11,6 +11,15 @@ namespace Internal
 
 	// Allow the aliases to use quads.
 	struct Quad;
+
+	// Allow the hints to reference the index tree.
+	class IndexTree;
+
+	// Allow the aliases to use sweep hits.
+	struct SweepHit;
+
+	// Allow the aliases to use histogram cells.
+	struct HistogramCell;
 }
 }
 }
@@ -7,6 +7,14 @@ inline namespace Spatial
 {
 namespace Internal
 {
+	// Extent of no shapes. It is inverted, so the growing of it by the rect gives exactly that rect, and it intersects no rect.
+	inline const BoundingRect EMPTY_EXTENT{
+		{ std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity() },
+		{ -std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity() },
+		std::ignore
+	};
+
+
 	/**
 		@brief	Quad tree quadrant.
 
@@ -18,18 +26,79 @@ namespace Internal
 		Each quad is placed at some level of quad tree and describes it's own bounding rect.
 		If quad represents leaf, it's bound consists of each indexed point.
 		If quad represents subtree, stored quads represent the quarters of quad bounds.
+
+		Quad may hold the pending shapes, which belong to its subtree, but are not distributed among the quad and its quarters yet.
+		Pending shapes are distributed only once the searching descends into the quad.
+
+		Besides the geometric bounds, quad keeps the tight extents of its own shapes and of the shapes of whole subtree.
+		Searching tests the extents instead of the bounds, so the empty parts of quadrants are skipped.
 	*/
 	struct Quad final
 	{
 		Shapes			shapes;				// Collection of shapes uniquely indexed by quad.
+		ShapesBounds	shapes_bounds;		// Bounds of shapes indexed by quad, stored in the same order as the shapes.
+		Shapes			pending_shapes;		// Collection of shapes placed to the subtree of quad, but not distributed yet.
 		Quarters		quarters;			// Quarters of quad.
+		Quad*			parent = nullptr;	// Parent quad, which holds this one as quarter. The root quad has no parent.
 
 		size_t			level;				// Level of quadrant in quad tree.
+		size_t			shapes_count = 0;	// Count of shapes indexed by the whole subtree of quad.
+		uint64_t		categories = 0;		// Union of categories of shapes indexed by the whole subtree of quad.
+		double			shapes_area = 0.0;	// Total area of bounds of shapes indexed by the whole subtree of quad.
+		uint64_t		epoch = 0;			// Latest epoch of changes of shapes in the whole subtree of quad. It is kept after the removal of shapes.
+		Vector2f		max_shape_size{ 0.0f, 0.0f };	// Per-axis maximum of sizes of shapes in the whole subtree of quad. It is kept after the removal of shapes.
 
 		BoundingRect	bounds;				// Bounding rect of quadrant.
 		Vector2f		center;				// Center of quadrant bounds.
+		BoundingRect	shapes_extent{ EMPTY_EXTENT };	// Tight bounds of shapes indexed by quad itself.
+		BoundingRect	subtree_extent{ EMPTY_EXTENT };	// Bounds of shapes indexed by the whole subtree of quad. It is tight unless the quad has pending shapes.
 
 		bool			is_leaf = false;	// Whether the quad stores no subtree of quarters.
+		QuadLock		lock;				// Lock of quad, taken only by the concurrent updating of tree.
+	};
+
+
+	/**
+		@brief	Quadrant of point tree.
+
+		Point quad is either the leaf, which stores the points, or the subtree of exactly four quarters, which stores no points.
+		Points always fit a single quarter, so no point is ever stored by subtree. Quarters are stored next to each other.
+		Points of leaf are stored by components in separate arrays, so the points may be tested in batches.
+	*/
+	struct PointQuad final
+	{
+		std::vector<float>	xs;					// X components of points.
+		std::vector<float>	ys;					// Y components of points.
+		std::vector<size_t>	tags;				// Tags of points.
+
+		BoundingRect		bounds;				// Bounding rect of quadrant.
+		size_t				level;				// Level of quadrant in point tree.
+		size_t				first_quarter = 0;	// Index of the first quarter. The root is never a quarter, so leafs have zero index.
+		size_t				points_count = 0;	// Count of points in the whole subtree of quad.
+	};
+
+
+	/**
+		@brief	Shape hit by sweeping.
+
+		Sweeping moves the bounds along the displacement. Time of impact is the fraction of displacement, where the moving bounds
+		touches the shape for the first time. It lies in range `[0, 1]` and it is `0` for shapes, that intersect the bounds before the moving.
+	*/
+	struct SweepHit final
+	{
+		const Shape*	shape;	// Shape hit.
+		float			time;	// Time of impact.
+	};
+
+	/**
+		@brief	Cell of shapes histogram.
+
+		Cell aggregates the shapes, which centers lie in the cell. The whole area of each shape bounds is accounted by single cell.
+	*/
+	struct HistogramCell final
+	{
+		size_t	shapes_count	= 0;	// Count of shapes in cell.
+		double	shapes_area		= 0.0;	// Total area of shapes bounds in cell.
 	};
 }
 }
@@ -4,12 +4,22 @@
 // Most fundamental dependencies.
 #include <demo/math/math.h>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
 #include <vector>
-#include <list>
 #include <queue>
 #include <memory>
+#include <memory_resource>
 #include <optional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <variant>
 
 
@@ -31,9 +41,13 @@ namespace Internal
 // Most fundamental declarations.
 #include "forwards.h"
 #include "internal/forwards.h"
+#include "QueryOptions.h"
 
 // Internal definitions.
 #include "internal/aliases.h"
+#include "internal/QuadLock.h"
+#include "internal/ThreadShards.h"
+#include "internal/GridCoordinates.h"
 #include "internal/structures.h"
 
 #include "internal/Shape.h"
@@ -42,8 +56,22 @@ namespace Internal
 #include "internal/QuadProvider.h"
 
 #include "internal/IndexTree.h"
+#include "internal/GridIndex.h"
+#include "internal/HistogramGrid.h"
+#include "internal/TopShapes.h"
+
+#include "internal/QueryMemory.h"
+#include "internal/ResultOrdering.h"
 
 // Public definitions.
+#include "QueryArena.h"
+#include "QueryHint.h"
 #include "QuadTree.h"
+#include "Subscription.h"
+#include "TraceRecorder.h"
+#include "ShardedQuadTree.h"
+#include "StreamingQuadTree.h"
+#include "PointTree.h"
 
 // Deferred inline definitions.
+#include "QuadTree.inl"
@@ -3,7 +3,566 @@
 #include <demo/spatial/spatial.h>
 
 
-int main()
+namespace
+{
+	// Clock to measure the benchmarks.
+	using BenchmarkClock = std::chrono::steady_clock;
+
+	// Count of dynamic allocations performed by the process.
+	std::atomic<size_t> allocations_count{ 0 };
+
+	// Distribution of shapes across the space.
+	enum class Distribution
+	{
+		Uniform,	// Shapes are spread uniformly across the whole space.
+		Clustered,	// Shapes are gathered in a few dense clusters.
+	};
+
+
+	// Get the time elapsed since given moment, in milliseconds.
+	const double GetElapsedMilliseconds( const BenchmarkClock::time_point start )
+	{
+		return std::chrono::duration<double, std::milli>( BenchmarkClock::now() - start ).count();
+	}
+
+	// Generate the bounds of shapes for benchmark.
+	std::vector<Demo::BoundingRect> GenerateBounds( const Distribution distribution, const size_t count, const float space_size )
+	{
+		std::minstd_rand					randomizer{ 42 };
+		std::uniform_real_distribution<float>	unit_distribution{ 0.0f, 1.0f };
+		std::normal_distribution<float>		cluster_distribution{ 0.0f, space_size * 0.02f };
+
+		std::vector<Demo::Vector2f> cluster_centers;
+		for( size_t index = 0; index < 8; ++index )
+		{
+			cluster_centers.emplace_back( space_size * unit_distribution( randomizer ), space_size * unit_distribution( randomizer ) );
+		}
+
+		std::vector<Demo::BoundingRect> result;
+		result.reserve( count );
+		for( size_t index = 0; index < count; ++index )
+		{
+			Demo::Vector2f center{ space_size * unit_distribution( randomizer ), space_size * unit_distribution( randomizer ) };
+			if( distribution == Distribution::Clustered )
+			{
+				center = cluster_centers[ index % cluster_centers.size() ] + Demo::Vector2f{ cluster_distribution( randomizer ), cluster_distribution( randomizer ) };
+			}
+
+			result.emplace_back( Demo::BoundingRect{ center }.Resize( 0.5f + unit_distribution( randomizer ) ) );
+		}
+
+		return result;
+	}
+
+	// Measure the building, searching and moving of shapes using given kind of index.
+	void RunBackendBenchmark( const Demo::QuadTree::IndexKind index_kind, const std::vector<Demo::BoundingRect>& bounds, const float space_size )
+	{
+		constexpr size_t QUERIES_COUNT	= 10000;
+		constexpr float QUERY_SIZE		= 8.0f;
+		constexpr float MOVE_DISTANCE	= 0.25f;
+
+		Demo::QuadTree tree{ index_kind };
+		std::vector<Demo::QuadTree::SharedShape> shapes;
+		shapes.reserve( bounds.size() );
+
+		const auto build_start = BenchmarkClock::now();
+		for( const auto& shape_bounds : bounds )
+		{
+			shapes.emplace_back( tree.Acquire( shape_bounds ) );
+		}
+		tree.Find( tree.GetBounds() );
+		const double build_time = GetElapsedMilliseconds( build_start );
+
+		std::minstd_rand						randomizer{ 7 };
+		std::uniform_real_distribution<float>	position_distribution{ 0.0f, space_size };
+
+		Demo::QueryArena arena;
+		size_t found_count = 0;
+		const auto find_start = BenchmarkClock::now();
+		for( size_t index = 0; index < QUERIES_COUNT; ++index )
+		{
+			Demo::QueryArenaScope arena_scope{ arena };
+
+			const Demo::Vector2f center{ position_distribution( randomizer ), position_distribution( randomizer ) };
+			found_count += tree.Find( Demo::BoundingRect{ center }.Resize( QUERY_SIZE ) ).size();
+
+			arena.Reset();
+		}
+		const double find_time = GetElapsedMilliseconds( find_start );
+
+		const auto move_start = BenchmarkClock::now();
+		for( size_t index = 0; index < shapes.size(); ++index )
+		{
+			const float direction = ( index & 1 )? MOVE_DISTANCE : -MOVE_DISTANCE;
+			Demo::BoundingRect moved_bounds{ shapes[ index ]->GetBounds() };
+			moved_bounds.min += { direction, direction };
+			moved_bounds.max += { direction, direction };
+			shapes[ index ]->SetBounds( moved_bounds );
+		}
+		const double move_time = GetElapsedMilliseconds( move_start );
+
+		std::printf(
+			"  %-5s build: %9.3f ms, find: %9.3f ms (%zu found), move: %9.3f ms\n",
+			( index_kind == Demo::QuadTree::IndexKind::Grid )? "grid" : "tree",
+			build_time,
+			find_time,
+			found_count,
+			move_time
+		);
+	}
+
+	// Acquire the shapes from several threads at once, each thread in its own stripe of space, then release them the same way.
+	void RunConcurrencyBenchmark( const size_t threads_count, const size_t shapes_count, const float space_size )
+	{
+		Demo::QuadTree tree;
+
+		// Bounds are set up before the concurrent updates, so they never grow during the measuring.
+		std::vector<Demo::QuadTree::SharedShape> corners{
+			tree.Acquire( Demo::BoundingRect{ { 0.0f, 0.0f } } ),
+			tree.Acquire( Demo::BoundingRect{ { space_size, space_size } } ),
+		};
+		tree.Find( tree.GetBounds() );
+		tree.SetConcurrentUpdates( true );
+
+		std::vector<std::vector<Demo::QuadTree::SharedShape>> thread_shapes( threads_count );
+		auto run_threads = [threads_count]( auto&& function )
+		{
+			const auto start = BenchmarkClock::now();
+
+			std::vector<std::thread> threads;
+			for( size_t thread_index = 0; thread_index < threads_count; ++thread_index )
+			{
+				threads.emplace_back( function, thread_index );
+			}
+
+			for( auto& thread : threads )
+			{
+				thread.join();
+			}
+
+			return GetElapsedMilliseconds( start );
+		};
+
+		const double acquire_time = run_threads(
+			[&tree, &thread_shapes, threads_count, shapes_count, space_size]( const size_t thread_index )
+			{
+				std::minstd_rand						randomizer{ uint32_t( thread_index + 1 ) };
+				std::uniform_real_distribution<float>	unit_distribution{ 0.0f, 1.0f };
+
+				const float stripe_size = space_size / float( threads_count );
+				auto& shapes = thread_shapes[ thread_index ];
+				shapes.reserve( shapes_count / threads_count );
+				for( size_t index = 0; index < shapes_count / threads_count; ++index )
+				{
+					const Demo::Vector2f center{ stripe_size * ( float( thread_index ) + unit_distribution( randomizer ) ), space_size * unit_distribution( randomizer ) };
+					shapes.emplace_back( tree.Acquire( Demo::BoundingRect{ center }.Resize( 0.5f ) ) );
+				}
+			}
+		);
+
+		const double release_time = run_threads( [&thread_shapes]( const size_t thread_index ) { thread_shapes[ thread_index ].clear(); } );
+
+		tree.SetConcurrentUpdates( false );
+		std::printf(
+			"  %zu threads, acquire: %9.3f ms, release: %9.3f ms\n",
+			threads_count,
+			acquire_time,
+			release_time
+		);
+	}
+
+	// Measure the scaling of concurrent acquiring and releasing of shapes across the counts of threads.
+	// Only the tree is measured, since the updates of grid are serialized.
+	void RunConcurrencyBenchmarks()
+	{
+		constexpr size_t SHAPES_COUNT	= 200000;
+		constexpr float SPACE_SIZE		= 1000.0f;
+
+		std::printf( "%zu shapes, concurrent updates of tree:\n", SHAPES_COUNT );
+		for( const size_t threads_count : { size_t( 1 ), size_t( 2 ), size_t( 4 ), size_t( 8 ) } )
+		{
+			RunConcurrencyBenchmark( threads_count, SHAPES_COUNT, SPACE_SIZE );
+		}
+	}
+
+	// Acquire and release the shapes randomly from several threads at once, then validate the index against the shapes left alive.
+	const bool RunConcurrencyStress( const Demo::QuadTree::IndexKind index_kind )
+	{
+		constexpr size_t THREADS_COUNT	= 8;
+		constexpr size_t ROUNDS_COUNT	= 50000;
+		constexpr size_t QUERIES_COUNT	= 1000;
+		constexpr float SPACE_SIZE		= 1000.0f;
+
+		Demo::QuadTree tree{ index_kind };
+		std::vector<Demo::QuadTree::SharedShape> corners{
+			tree.Acquire( Demo::BoundingRect{ { 0.0f, 0.0f } } ),
+			tree.Acquire( Demo::BoundingRect{ { SPACE_SIZE, SPACE_SIZE } } ),
+		};
+		tree.Find( tree.GetBounds() );
+		tree.SetConcurrentUpdates( true );
+
+		// Threads share the whole space, some shapes are large enough to stay in shallow quads and few of them grow the bounds.
+		std::vector<std::vector<Demo::QuadTree::SharedShape>> thread_shapes( THREADS_COUNT );
+		std::vector<std::thread> threads;
+		for( size_t thread_index = 0; thread_index < THREADS_COUNT; ++thread_index )
+		{
+			threads.emplace_back(
+				[&tree, &shapes = thread_shapes[ thread_index ], thread_index]()
+				{
+					std::minstd_rand						randomizer{ uint32_t( thread_index + 1 ) };
+					std::uniform_real_distribution<float>	unit_distribution{ 0.0f, 1.0f };
+
+					for( size_t round = 0; round < ROUNDS_COUNT; ++round )
+					{
+						if( !shapes.empty() && ( unit_distribution( randomizer ) < 0.45f ) )
+						{
+							std::swap( shapes[ randomizer() % shapes.size() ], shapes.back() );
+							shapes.pop_back();
+							continue;
+						}
+
+						const float space_size = ( round % 10000 == 9999 )? SPACE_SIZE * 1.1f : SPACE_SIZE;
+						const Demo::Vector2f center{ space_size * unit_distribution( randomizer ), space_size * unit_distribution( randomizer ) };
+						const float size = ( round % 50 == 0 )? 100.0f * unit_distribution( randomizer ) : 0.5f + unit_distribution( randomizer );
+						shapes.emplace_back( tree.Acquire( Demo::BoundingRect{ center }.Resize( size ) ) );
+					}
+				}
+			);
+		}
+
+		for( auto& thread : threads )
+		{
+			thread.join();
+		}
+
+		tree.SetConcurrentUpdates( false );
+
+		std::vector<Demo::QuadTree::SharedShape> alive_shapes{ corners };
+		for( const auto& shapes : thread_shapes )
+		{
+			alive_shapes.insert( alive_shapes.end(), shapes.begin(), shapes.end() );
+		}
+
+		size_t failures_count = ( tree.Find( tree.GetBounds() ).size() == alive_shapes.size() )? 0 : 1;
+
+		std::minstd_rand						randomizer{ 11 };
+		std::uniform_real_distribution<float>	position_distribution{ 0.0f, SPACE_SIZE };
+		for( size_t index = 0; index < QUERIES_COUNT; ++index )
+		{
+			const Demo::BoundingRect query_bounds{ Demo::BoundingRect{ { position_distribution( randomizer ), position_distribution( randomizer ) } }.Resize( 20.0f ) };
+			const size_t expected_count = size_t( std::count_if(
+				alive_shapes.begin(),
+				alive_shapes.end(),
+				[&query_bounds]( const Demo::QuadTree::SharedShape& shape ) { return query_bounds.IsIntersects( shape->GetBounds() ); }
+			) );
+
+			if( ( tree.Find( query_bounds ).size() != expected_count ) || ( tree.Count( query_bounds ) != expected_count ) )
+			{
+				++failures_count;
+			}
+		}
+
+		std::printf(
+			"  %-5s %zu threads, %zu alive shapes, %zu failures\n",
+			( index_kind == Demo::QuadTree::IndexKind::Grid )? "grid" : "tree",
+			THREADS_COUNT,
+			alive_shapes.size(),
+			failures_count
+		);
+
+		return failures_count == 0;
+	}
+
+	// Search with hint along a random walk of integer-aligned bounds, then validate each result against the brute force searching.
+	// Bounds and shapes share the edges with quads of tree, so the shapes of neighbouring quads are hit by the edges of bounds.
+	const bool RunHintedSearchStress()
+	{
+		constexpr size_t SHAPES_COUNT	= 3000;
+		constexpr size_t QUERIES_COUNT	= 5000;
+		constexpr int SPACE_SIZE		= 256;
+		constexpr int MAX_SIZE			= 4;
+
+		std::minstd_rand					randomizer{ 7 };
+		std::uniform_int_distribution<int>	position_distribution{ 0, SPACE_SIZE - MAX_SIZE };
+		std::uniform_int_distribution<int>	size_distribution{ 0, MAX_SIZE };
+		std::uniform_int_distribution<int>	step_distribution{ -8, 8 };
+
+		auto make_bounds = [&randomizer, &size_distribution]( const int x, const int y ) -> Demo::BoundingRect
+		{
+			const Demo::Vector2f min{ float( x ), float( y ) };
+			return { min, min + Demo::Vector2f{ float( size_distribution( randomizer ) ), float( size_distribution( randomizer ) ) } };
+		};
+
+		Demo::QuadTree tree;
+		std::vector<Demo::QuadTree::SharedShape> shapes{
+			tree.Acquire( Demo::BoundingRect{ { 0.0f, 0.0f } } ),
+			tree.Acquire( Demo::BoundingRect{ { float( SPACE_SIZE ), float( SPACE_SIZE ) } } ),
+		};
+
+		for( size_t index = shapes.size(); index < SHAPES_COUNT; ++index )
+		{
+			shapes.emplace_back( tree.Acquire( make_bounds( position_distribution( randomizer ), position_distribution( randomizer ) ) ) );
+		}
+
+		Demo::QueryHint hint;
+		size_t failures_count	= 0;
+		int x					= SPACE_SIZE / 2;
+		int y					= SPACE_SIZE / 2;
+		for( size_t index = 0; index < QUERIES_COUNT; ++index )
+		{
+			// Walk jumps to random place from time to time, so the hint climbs up as well as down.
+			const bool is_jump	= ( index % 100 ) == 0;
+			x					= is_jump? position_distribution( randomizer ) : std::clamp( x + step_distribution( randomizer ), 0, SPACE_SIZE - MAX_SIZE );
+			y					= is_jump? position_distribution( randomizer ) : std::clamp( y + step_distribution( randomizer ), 0, SPACE_SIZE - MAX_SIZE );
+
+			const Demo::BoundingRect query_bounds{ make_bounds( x, y ) };
+			const size_t expected_count = size_t( std::count_if(
+				shapes.begin(),
+				shapes.end(),
+				[&query_bounds]( const Demo::QuadTree::SharedShape& shape ) { return query_bounds.IsIntersects( shape->GetBounds() ); }
+			) );
+
+			if( tree.Find( query_bounds, hint ).size() != expected_count )
+			{
+				++failures_count;
+			}
+		}
+
+		std::printf( "  tree  %zu shapes, %zu hinted queries, %zu failures\n", shapes.size(), QUERIES_COUNT, failures_count );
+		return failures_count == 0;
+	}
+
+	// Get the value at given fraction of sorted samples.
+	const double GetPercentile( const std::vector<double>& sorted_samples, const double fraction )
+	{
+		if( sorted_samples.empty() )
+		{
+			return 0.0;
+		}
+
+		return sorted_samples[ std::min( size_t( fraction * double( sorted_samples.size() ) ), sorted_samples.size() - 1 ) ];
+	}
+
+	// Re-execute the recorded trace using given kind of index. Throughput, latencies of searching and count of allocations are reported.
+	// Each kind of searching is measured, the found count sums the found shapes, hits, counted shapes and shapes of histogram cells.
+	void ReplayTrace( const Demo::QuadTree::IndexKind index_kind, const std::vector<Demo::TraceRecorder::Event>& events )
+	{
+		using Operation = Demo::TraceRecorder::Operation;
+
+		Demo::QuadTree tree{ index_kind };
+		std::vector<Demo::QuadTree::SharedShape> shapes;
+		std::vector<Demo::QueryHint> hints;
+
+		std::vector<double> find_latencies;
+		find_latencies.reserve( events.size() );
+
+		Demo::QueryArena arena;
+		size_t found_count = 0;
+
+		// Measure the searching, which returns the count of found items.
+		auto measure_find = [&arena, &find_latencies, &found_count]( auto&& find )
+		{
+			Demo::QueryArenaScope arena_scope{ arena };
+
+			const auto find_start = BenchmarkClock::now();
+			found_count += find();
+			find_latencies.push_back( std::chrono::duration<double, std::micro>( BenchmarkClock::now() - find_start ).count() );
+
+			arena.Reset();
+		};
+
+		const size_t start_allocations_count = allocations_count.load( std::memory_order_relaxed );
+		const auto replay_start = BenchmarkClock::now();
+		for( const auto& event : events )
+		{
+			switch( event.operation )
+			{
+				case Operation::Acquire:
+				{
+					if( event.shape_id >= shapes.size() )
+					{
+						shapes.resize( size_t( event.shape_id ) + 1 );
+					}
+
+					shapes[ event.shape_id ] = tree.Acquire( event.bounds );
+					break;
+				}
+
+				case Operation::Release:
+				{
+					shapes[ event.shape_id ].reset();
+					break;
+				}
+
+				case Operation::Move:
+				{
+					shapes[ event.shape_id ]->SetBounds( event.bounds );
+					break;
+				}
+
+				case Operation::Categorize:
+				{
+					shapes[ event.shape_id ]->SetCategories( event.categories );
+					break;
+				}
+
+				case Operation::AdvanceEpoch:
+				{
+					tree.AdvanceEpoch();
+					break;
+				}
+
+				case Operation::Find:
+				{
+					measure_find( [&]() { return tree.Find( event.bounds ).size(); } );
+					break;
+				}
+
+				case Operation::FindHinted:
+				{
+					if( event.shape_id >= hints.size() )
+					{
+						hints.resize( size_t( event.shape_id ) + 1 );
+					}
+
+					measure_find( [&]() { return tree.Find( event.bounds, hints[ event.shape_id ] ).size(); } );
+					break;
+				}
+
+				case Operation::FindCategories:
+				{
+					measure_find( [&]() { return tree.Find( event.bounds, event.categories ).size(); } );
+					break;
+				}
+
+				case Operation::FindChangedSince:
+				{
+					measure_find( [&]() { return tree.FindChangedSince( event.bounds, event.epoch ).size(); } );
+					break;
+				}
+
+				case Operation::FindCircle:
+				{
+					measure_find( [&]() { return tree.Find( event.bounds.min, event.radius ).size(); } );
+					break;
+				}
+
+				case Operation::FindPolygon:
+				{
+					const Demo::ConvexPolygon polygon{ event.vertices };
+					measure_find( [&]() { return tree.Find( polygon ).size(); } );
+					break;
+				}
+
+				case Operation::FindOrdered:
+				{
+					measure_find( [&]() { return tree.Find( event.bounds, event.options ).size(); } );
+					break;
+				}
+
+				case Operation::FindCircleOrdered:
+				{
+					measure_find( [&]() { return tree.Find( event.bounds.min, event.radius, event.options ).size(); } );
+					break;
+				}
+
+				case Operation::FindSwept:
+				{
+					measure_find( [&]() { return tree.FindSwept( event.bounds, event.displacement, event.is_first_hit_only ).size(); } );
+					break;
+				}
+
+				case Operation::Any:
+				{
+					measure_find( [&]() { return size_t( tree.Any( event.bounds )? 1 : 0 ); } );
+					break;
+				}
+
+				case Operation::Count:
+				{
+					measure_find( [&]() { return tree.Count( event.bounds ); } );
+					break;
+				}
+
+				case Operation::FindTop:
+				{
+					measure_find( [&]() { return tree.FindTop( event.bounds, event.count, event.key, event.visits_budget ).size(); } );
+					break;
+				}
+
+				case Operation::Histogram:
+				{
+					measure_find(
+						[&]()
+						{
+							size_t cells_shapes_count = 0;
+							for( const auto& cell : tree.Histogram( event.bounds, event.columns, event.rows ) )
+							{
+								cells_shapes_count += cell.shapes_count;
+							}
+
+							return cells_shapes_count;
+						}
+					);
+					break;
+				}
+			}
+		}
+		const double replay_time = GetElapsedMilliseconds( replay_start );
+		const size_t replay_allocations_count = allocations_count.load( std::memory_order_relaxed ) - start_allocations_count;
+
+		std::sort( find_latencies.begin(), find_latencies.end() );
+		std::printf(
+			"  %-5s total: %9.3f ms, %11.0f ops/s, find p50: %8.3f us, p99: %8.3f us, p99.9: %8.3f us (%zu found), allocations: %zu\n",
+			( index_kind == Demo::QuadTree::IndexKind::Grid )? "grid" : "tree",
+			replay_time,
+			( replay_time > 0.0 )? double( events.size() ) * 1000.0 / replay_time : 0.0,
+			GetPercentile( find_latencies, 0.5 ),
+			GetPercentile( find_latencies, 0.99 ),
+			GetPercentile( find_latencies, 0.999 ),
+			found_count,
+			replay_allocations_count
+		);
+	}
+
+	// Replay the trace file against each kind of spatial index.
+	const bool RunTraceReplay( const char* trace_path )
+	{
+		const std::vector<Demo::TraceRecorder::Event> events{ Demo::TraceRecorder::Load( trace_path ) };
+		if( events.empty() )
+		{
+			std::printf( "Trace '%s' could not be read or has no events.\n", trace_path );
+			return false;
+		}
+
+		std::printf( "%zu events of trace '%s':\n", events.size(), trace_path );
+		ReplayTrace( Demo::QuadTree::IndexKind::Tree, events );
+		ReplayTrace( Demo::QuadTree::IndexKind::Grid, events );
+
+		return true;
+	}
+
+	// Compare the kinds of spatial index on different distributions of shapes.
+	void RunBackendBenchmarks()
+	{
+		constexpr float SPACE_SIZE = 1000.0f;
+
+		for( const size_t shapes_count : { size_t( 1000 ), size_t( 10000 ), size_t( 50000 ) } )
+		{
+			for( const auto distribution : { Distribution::Uniform, Distribution::Clustered } )
+			{
+				std::printf( "%zu shapes, %s distribution:\n", shapes_count, ( distribution == Distribution::Uniform )? "uniform" : "clustered" );
+
+				const std::vector<Demo::BoundingRect> bounds{ GenerateBounds( distribution, shapes_count, SPACE_SIZE ) };
+				RunBackendBenchmark( Demo::QuadTree::IndexKind::Tree, bounds, SPACE_SIZE );
+				RunBackendBenchmark( Demo::QuadTree::IndexKind::Grid, bounds, SPACE_SIZE );
+			}
+		}
+	}
+}
+
+
+int main( int arguments_count, char* arguments[] )
 {
 	const size_t shapes_count = 105;
 
@@ -55,5 +614,53 @@ int main()
 		}
 	}
 
+	// Benchmarks are performed only on demand.
+	if( ( arguments_count > 1 ) && ( std::string_view{ arguments[ 1 ] } == "--benchmark" ) )
+	{
+		RunBackendBenchmarks();
+		RunConcurrencyBenchmarks();
+	}
+
+	// Stress of concurrent updates is performed only on demand.
+	if( ( arguments_count > 1 ) && ( std::string_view{ arguments[ 1 ] } == "--stress" ) )
+	{
+		std::printf( "Concurrent updates stress:\n" );
+		const bool is_tree_valid = RunConcurrencyStress( Demo::QuadTree::IndexKind::Tree );
+		const bool is_grid_valid = RunConcurrencyStress( Demo::QuadTree::IndexKind::Grid );
+
+		std::printf( "Hinted searching stress:\n" );
+		const bool is_hint_valid = RunHintedSearchStress();
+		return ( is_tree_valid && is_grid_valid && is_hint_valid )? 0 : 1;
+	}
+
+	// Recorded workload is replayed only on demand.
+	if( ( arguments_count > 2 ) && ( std::string_view{ arguments[ 1 ] } == "--replay" ) )
+	{
+		return RunTraceReplay( arguments[ 2 ] )? 0 : 1;
+	}
+
 	return 0;
 }
+
+
+// Global allocation functions are replaced to count the allocations during the trace replay.
+void* operator new( const size_t size )
+{
+	allocations_count.fetch_add( 1, std::memory_order_relaxed );
+	if( void* memory = std::malloc( std::max<size_t>( size, 1 ) ) )
+	{
+		return memory;
+	}
+
+	throw std::bad_alloc{};
+}
+
+void operator delete( void* memory ) noexcept
+{
+	std::free( memory );
+}
+
+void operator delete( void* memory, const size_t ) noexcept
+{
+	std::free( memory );
+}
@@ -2,4 +2,10 @@
 
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
 #include <random>
+#include <string_view>